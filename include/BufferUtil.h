@@ -0,0 +1,63 @@
+#ifndef BUFFER_UTIL_H
+#define BUFFER_UTIL_H
+
+#include <Arduino.h>
+
+// 帧头/记录头编码、环形缓冲区拷贝和大缓冲区分配的公共函数
+
+// 以小端序写入 value 的低 bytes 字节
+inline void putLE(uint8_t* dst, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// 读取 bytes 字节的小端序整数
+inline uint64_t getLE(const uint8_t* src, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+// 从环形缓冲区 offset 处写入，超过末尾部分回绕到开头（offset < capacity，len <= capacity）
+inline void ringWrite(uint8_t* ring, size_t capacity, size_t offset, const uint8_t* data, size_t len) {
+    size_t first = min(len, capacity - offset);
+    memcpy(ring + offset, data, first);
+    memcpy(ring, data + first, len - first);
+}
+
+// 从环形缓冲区 offset 处读取，规则同 ringWrite
+inline void ringRead(const uint8_t* ring, size_t capacity, size_t offset, uint8_t* out, size_t len) {
+    size_t first = min(len, capacity - offset);
+    memcpy(out, ring + offset, first);
+    memcpy(out + first, ring, len - first);
+}
+
+// 分配大缓冲区：usePsram 且检测到PSRAM时从PSRAM分配，否则（或PSRAM分配失败时）
+// 从内部RAM分配；结果和所在内存写入日志，失败返回nullptr
+inline uint8_t* allocateBuffer(const char* name, size_t size, bool usePsram) {
+    uint8_t* buffer = nullptr;
+#if defined(ESP32)
+    if (usePsram && psramFound()) {
+        buffer = (uint8_t*)ps_malloc(size);
+        if (buffer) {
+            Serial.printf("%s buffer: %u bytes (PSRAM)\n", name, (unsigned)size);
+            return buffer;
+        }
+    }
+#endif
+    if (usePsram) {
+        Serial.printf("%s buffer: PSRAM unavailable, using internal RAM\n", name);
+    }
+    buffer = (uint8_t*)malloc(size);
+    if (buffer) {
+        Serial.printf("%s buffer: %u bytes (internal RAM)\n", name, (unsigned)size);
+    } else {
+        Serial.printf("Failed to allocate %s buffer (%u bytes)\n", name, (unsigned)size);
+    }
+    return buffer;
+}
+
+#endif // BUFFER_UTIL_H
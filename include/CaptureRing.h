@@ -0,0 +1,78 @@
+#ifndef CAPTURE_RING_H
+#define CAPTURE_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// 串口流量抓包环形缓冲区（双向，带时间戳）
+//
+// 只追加写入，满后覆盖最旧的记录。写入端（loop）不加锁；读取端（HTTP下载）
+// 拷贝后检查数据是否已被覆盖，被覆盖则跳到当前最旧的记录继续，类似seqlock。
+//
+// 下载流格式（小端序）：
+//   文件头（24字节）
+//     0   4   magic       "SCAP"
+//     4   1   version     当前为 1
+//     5   1   flags       bit0 = 设备时钟已通过SNTP同步
+//     6   2   reserved
+//     8   8   now_us      下载时的设备单调时钟（微秒），用于还原毫秒时间戳回绕
+//     16  8   offset_us   单调时钟到Unix时间的偏移（微秒，有符号）
+//   记录（重复）
+//     0   4   ts_ms       设备单调时钟（毫秒，低32位）
+//     4   2   ts_us       毫秒内的微秒 (0-999)
+//     6   2   length_dir  bit15 = 方向 (0: 串口->网络, 1: 网络->串口)，低15位为数据长度
+//     8   N   data
+class CaptureRing {
+public:
+    enum Direction {
+        DIR_SERIAL_TO_NET = 0,
+        DIR_NET_TO_SERIAL = 1
+    };
+
+    static const size_t FILE_HEADER_SIZE = 24;
+    static const size_t RECORD_HEADER_SIZE = 8;
+    static const size_t MAX_RECORD_DATA = 256;  // 更长的数据拆分为多条记录
+
+    // 下载游标（每个HTTP请求一个）
+    struct Reader {
+        uint32_t cursor;
+        uint32_t end;
+        bool headerSent;
+        bool synced;
+        uint64_t openedUs;
+        int64_t clockOffset;
+    };
+
+    CaptureRing();
+    ~CaptureRing();
+
+    // 分配缓冲区，容量向下取整为2的幂；分配策略见 allocateBuffer()
+    bool begin(size_t capacity, bool usePsram);
+
+    bool isEnabled() const;
+    size_t getCapacity() const;
+
+    // 追加一段数据（仅在loop中调用）
+    void append(Direction direction, const uint8_t* data, size_t len, uint64_t timestampUs);
+
+    // 从当前最旧的记录开始，到调用时最新的记录为止
+    Reader openReader(uint64_t nowUs, int64_t clockOffset, bool synced) const;
+
+    // 读取整条记录到out，返回写入字节数；空间不足一条记录时返回0
+    size_t read(Reader& reader, uint8_t* out, size_t maxLen) const;
+
+    // 是否已读取完毕
+    bool isDone(const Reader& reader) const;
+
+private:
+    uint8_t* buffer;
+    uint32_t mask;
+    std::atomic<uint32_t> head;  // 累计写入字节数（下一条记录的位置）
+    std::atomic<uint32_t> tail;  // 最旧的有效记录位置
+
+    void appendRecord(Direction direction, const uint8_t* data, size_t len, uint64_t timestampUs);
+    void copyIn(uint32_t position, const uint8_t* data, size_t len);
+    void copyOut(uint32_t position, uint8_t* out, size_t len) const;
+};
+
+#endif // CAPTURE_RING_H
@@ -3,13 +3,20 @@
 
 #include <Arduino.h>
 
+// WebSocket服务器端点数量上限（按顺序为优先级）
+const size_t MAX_WS_ENDPOINTS = 4;
+
 // 配置参数结构体
 struct DeviceConfig {
     char wifi_ssid[32];
     char wifi_password[64];
-    char websocket_url[128];
+    char websocket_urls[MAX_WS_ENDPOINTS][128]; // 服务器列表，空字符串表示未使用
     uint32_t serial_baud_rate;
     bool simulate_serial; // 是否模拟串口数据
+    bool timestamp_frames; // 是否使用带时间戳的二进制帧
+    char ntp_server[64];   // SNTP服务器（用于时钟偏移）
+    char filter_rules[256]; // 串口行过滤规则（每行一条，空则全部转发）
+    bool power_save;       // 低功耗模式（空闲时休眠等待串口数据）
     bool configured;  // 标记是否已配置
 };
 
@@ -40,6 +47,9 @@ private:
     DeviceConfig config;
     static const char* NAMESPACE;
     static const char* CONFIG_VERSION;
+    
+    // 服务器URL在NVS中的键名
+    static String urlKey(size_t index);
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,94 @@
+#ifndef ENDPOINT_MANAGER_H
+#define ENDPOINT_MANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+
+// WebSocket服务器端点管理：健康跟踪、按延迟选择、故障切换与回切
+//
+// 每个端点的得分 = 延迟（WebSocket ping RTT 与 TCP 连接探测耗时的移动平均）
+//                  + 顺序惩罚（列表中越靠后越高）
+// 选择得分最低的健康端点；连续失败达到阈值的端点进入退避，退避结束后
+// 由定期探测重新验证，恢复后若得分明显更低则自动回切。
+// 探测使用 AsyncClient（异步DNS和连接），不阻塞主循环。
+class EndpointManager {
+public:
+    static const uint8_t FAILURE_THRESHOLD = 2;      // 连续失败次数达到后视为不健康
+    // TCP连接探测超时（含DNS解析），与正式连接的超时一致；超时按耗时记为延迟，不记失败
+    static const uint32_t PROBE_TIMEOUT_MS = 10000;
+
+    EndpointManager();
+
+    // 加载配置中的服务器列表（跳过空URL），返回端点数量
+    // config 需在整个运行期间有效
+    size_t begin(const DeviceConfig& config);
+
+    size_t getCount() const;
+    const char* getUrl(int index) const;
+
+    // 当前使用的端点（未连接过时为-1）
+    int getCurrent() const;
+    void setCurrent(int index);
+
+    // 选择得分最低的可用端点
+    int selectBest() const;
+
+    // 需要切换时返回目标端点，否则返回-1
+    int selectSwitchTarget() const;
+
+    void recordSuccess(int index);
+    void recordFailure(int index);
+    void recordLatency(int index, uint32_t latencyMs);
+
+    bool isHealthy(int index) const;
+    uint32_t getLatency(int index) const;
+    uint8_t getFailures(int index) const;
+
+    // 对下一个非当前端点发起一次异步TCP连接探测，返回被探测的端点
+    // 上一次探测未结束或没有可探测的端点时返回-1
+    int startProbe();
+
+    // 在loop中调用：探测完成或超时后记录结果
+    void updateProbe();
+
+    // 解析 ws:// / wss:// URL
+    static void parseUrl(const char* url, String& host, int& port, String& path);
+
+private:
+    struct Endpoint {
+        const char* url;
+        uint32_t latency;       // 毫秒，0表示尚无样本
+        uint8_t failures;       // 连续失败次数
+        unsigned long retryAt;  // 不健康时，允许重试的时间
+    };
+
+    Endpoint endpoints[MAX_WS_ENDPOINTS];
+    size_t count;
+    int current;
+    size_t probeCursor;
+
+    // 探测状态，与 AsyncClient 回调共享
+    enum ProbeState : uint8_t {
+        PROBE_IDLE,
+        PROBE_PENDING,
+        PROBE_CONNECTED,
+        PROBE_FAILED
+    };
+    int probeIndex;
+    unsigned long probeStart;
+    std::atomic<uint8_t> probeState;
+    std::atomic<bool> probeClientBusy;          // 上一次探测的连接对象尚未释放
+    std::atomic<unsigned long> probeConnectedAt;
+
+    static const uint32_t UNKNOWN_LATENCY_MS;
+    static const uint32_t PRIORITY_PENALTY_MS;
+    static const uint32_t SWITCH_MARGIN_MS;
+    static const unsigned long BASE_BACKOFF_MS;
+    static const unsigned long MAX_BACKOFF_MS;
+
+    bool isEligible(int index) const;
+    uint32_t score(int index) const;
+};
+
+#endif // ENDPOINT_MANAGER_H
@@ -0,0 +1,21 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include "FrameStamper.h"
+
+// 串口数据帧缓冲区：数据前预留时间戳帧头空间，启用时间戳帧时原地写入帧头，无需拷贝
+template <size_t PayloadCapacity>
+class FrameBuffer {
+public:
+    static const size_t CAPACITY = PayloadCapacity;
+    static const size_t SIZE = FrameStamper::HEADER_SIZE + PayloadCapacity;
+
+    uint8_t data[SIZE];
+
+    uint8_t* payload() {
+        return data + FrameStamper::HEADER_SIZE;
+    }
+};
+
+#endif // FRAME_BUFFER_H
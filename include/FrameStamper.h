@@ -0,0 +1,61 @@
+#ifndef FRAME_STAMPER_H
+#define FRAME_STAMPER_H
+
+#include <Arduino.h>
+
+// 帧时间戳封装（用于串口 -> 服务器的逐跳延迟追踪）
+//
+// 启用后每个WebSocket帧以二进制发送，帧头格式如下（小端序，共32字节）：
+//   偏移  长度  字段
+//   0     2     magic       固定为 'S' 'B'
+//   2     1     version     当前为 1
+//   3     1     flags       bit0 = 设备时钟已通过SNTP同步
+//   4     4     seq         帧序号（从0开始递增，组帧时分配，断线补发时不变）
+//   8     8     capture_us  首字节进入RX路径时的设备单调时钟（微秒），见 SerialReceiver.h
+//                           ESP32 为UART驱动接收事件的时间，ESP8266 为 loop() 轮询到数据的时间
+//   16    8     send_us     调用发送前的设备单调时钟（微秒）
+//   24    8     offset_us   单调时钟到Unix时间的偏移（微秒，有符号）
+//   32    ...   payload     原始串口数据
+//
+// 服务器端: capture_us + offset_us 即为采集时刻的Unix时间（微秒）。
+class FrameStamper {
+public:
+    static const size_t HEADER_SIZE = 32;
+
+    FrameStamper();
+
+    // 启动SNTP同步（ntpServer为空时不同步，仅提供单调时间戳）
+    void begin(const char* ntpServer);
+
+    // 周期性刷新时钟偏移，在loop()中调用
+    void update();
+
+    // 设备单调时钟（微秒）
+    static uint64_t nowMicros();
+
+    // 时钟是否已同步
+    bool isSynced() const;
+
+    // 单调时钟到Unix时间的偏移（微秒）
+    int64_t getClockOffset() const;
+
+    // 为新组成的一帧分配序号（在进入发送或待发缓冲区之前调用）
+    uint32_t nextSequence();
+
+    // 在header处写入帧头（header需预留HEADER_SIZE字节）
+    void writeHeader(uint8_t* header, uint32_t sequence, uint64_t captureUs);
+
+private:
+    uint32_t sequence;
+    int64_t clockOffset;
+    bool synced;
+    bool sntpEnabled;
+    unsigned long lastSyncCheck;
+
+    static const uint8_t VERSION;
+    static const uint8_t FLAG_SYNCED;
+    static const unsigned long SYNC_RETRY_INTERVAL;
+    static const unsigned long SYNC_REFRESH_INTERVAL;
+};
+
+#endif // FRAME_STAMPER_H
@@ -0,0 +1,96 @@
+#ifndef LINE_FILTER_H
+#define LINE_FILTER_H
+
+#include <Arduino.h>
+#include "Profile.h"
+
+// 串口行过滤器（串口 -> WebSocket 方向）
+//
+// 规则每行一条，按顺序匹配，第一条命中的规则生效：
+//   +ERR            转发以 "ERR" 开头的行
+//   -DBG            丢弃以 "DBG" 开头的行
+//   +*panic         转发包含 "panic" 的行（模式以 '*' 开头表示包含匹配）
+//   +E?? rate=5     '?' 匹配任意单个字符；rate=N 限制每秒最多转发N行
+//   +FAULT ctx=2    同时转发命中行前后各2行上下文
+//   # 注释
+//
+// 模式到第一个空格为止。未命中任何规则的行：存在 '+' 规则时丢弃，否则转发。
+// 规则在加载配置时编译为首字节分派表，运行时按行匹配，不逐字节解释。
+class LineFilter {
+public:
+    static const size_t MAX_RULES = 16;
+    static const size_t MAX_LINE = BRIDGE_FILTER_MAX_LINE; // 超长行按此长度截断为多段分别匹配
+    static const size_t MAX_CONTEXT = 4;
+    static const size_t MAX_RULES_TEXT = 256;
+    // feed()/flush() 输出相对输入的最大增量（暂存的上下文行 + 跨块的半行）
+    static const size_t MAX_EXPANSION = (MAX_CONTEXT + 1) * MAX_LINE;
+
+    LineFilter();
+
+    // 编译规则，失败时过滤器保持关闭（全部转发）
+    bool compile(const char* rulesText);
+
+    // 是否有生效的规则
+    bool isActive() const;
+
+    // 输入串口数据（captureUs 为这块数据的采集时间），将需要转发的完整行写入out，返回写入字节数
+    // out 至少需要 len + MAX_EXPANSION 字节
+    // firstCaptureUs 返回输出中第一行首字节的采集时间（可能早于本块，如跨块的半行、上下文行），
+    // 未输出时不修改
+    size_t feed(const uint8_t* data, size_t len, uint64_t captureUs, uint8_t* out, uint64_t& firstCaptureUs);
+
+    // 将未以换行结束的半行作为完整行处理（用于空闲超时），out 至少 MAX_EXPANSION 字节
+    // captureUs 含义同 feed() 的 firstCaptureUs
+    size_t flush(uint8_t* out, uint64_t& captureUs);
+
+    // 是否有未处理完的半行
+    bool hasPending() const;
+
+    uint32_t getForwardedLines() const;
+    uint32_t getDroppedLines() const;
+
+private:
+    struct Rule {
+        const char* pattern;
+        uint16_t patternLength;
+        bool forward;      // '+' 转发 / '-' 丢弃
+        bool contains;     // 包含匹配 / 前缀匹配
+        uint8_t context;
+        uint16_t ratePerSecond; // 0 表示不限速
+        uint16_t windowCount;
+        unsigned long windowStart;
+    };
+
+    char rulesText[MAX_RULES_TEXT];
+    Rule rules[MAX_RULES];
+    size_t ruleCount;
+    uint16_t firstByteRules[256]; // 首字节 -> 可能命中的前缀规则位图
+    uint16_t containsRules;       // 包含匹配规则位图（每行都需检查）
+    bool hasForwardRules;
+    uint8_t maxContext;
+
+    uint8_t line[MAX_LINE];
+    size_t lineLength;
+    uint64_t lineCaptureUs; // 当前行首字节的采集时间
+
+    uint8_t history[MAX_CONTEXT][MAX_LINE];
+    uint16_t historyLength[MAX_CONTEXT];
+    uint64_t historyCaptureUs[MAX_CONTEXT];
+    uint8_t historyHead;
+    uint8_t historyCount;
+    uint8_t afterContext;
+
+    uint32_t forwardedLines;
+    uint32_t droppedLines;
+
+    void reset();
+    bool parseRule(char* text);
+    int findRule() const;
+    bool ruleMatches(const Rule& rule) const;
+    bool allowRate(Rule& rule);
+    size_t processLine(uint8_t* out, uint64_t& firstCaptureUs);
+    size_t flushHistory(uint8_t* out, size_t lines, uint64_t& firstCaptureUs);
+    void pushHistory();
+};
+
+#endif // LINE_FILTER_H
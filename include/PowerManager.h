@@ -0,0 +1,60 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "SerialReceiver.h"
+
+// 低功耗模式：空闲时阻塞等待串口数据，代替 loop() 空转
+//
+// - WiFi 使用 modem-sleep，在 DTIM 间隔之间关闭射频
+// - ESP32：阻塞在 UART 接收事件上（SerialReceiver），CPU 在空闲任务中停机
+// - ESP8266：以1ms为粒度 delay()，让出CPU给SDK；CPU不停机，省电只来自 modem-sleep
+// 每次最多阻塞 IDLE_WAIT_MS，以便 webSocket.loop() 处理网络数据和心跳。
+// 占空比只把真正的阻塞等待计为休眠，因此 ESP8266 上恒为100%。
+class PowerManager {
+public:
+    static const uint32_t IDLE_WAIT_MS = 10;
+
+    PowerManager();
+
+    // 启用低功耗模式（需在 SerialReceiver::begin() 和WiFi连接之后调用）
+    void begin(SerialReceiver& serialReceiver);
+
+    bool isEnabled() const;
+
+    // 无串口数据时阻塞，直到有数据或超时
+    void waitForWork();
+
+    // 一次串口数据转发完成（统计唤醒到发出的延迟；数据全部被过滤时也调用）
+    void noteForwarded();
+
+    // 本次唤醒的数据未能发出而进入待发缓冲区，结束本次唤醒但不计入延迟统计
+    void noteSpooled();
+
+    // 最近统计窗口内的CPU占空比（百分比，ESP8266 上恒为100）
+    float getDutyCycle() const;
+
+    uint32_t getWakeups() const;
+    uint32_t getSpooledWakeups() const;
+    uint32_t getAvgWakeLatencyUs() const;
+    uint32_t getMaxWakeLatencyUs() const;
+
+private:
+    SerialReceiver* receiver;
+    bool enabled;
+    bool wakePending;
+    uint64_t wakeTime;
+    uint64_t windowStart;
+    uint64_t windowSleep;
+    float dutyCycle;
+    uint32_t wakeups;
+    uint32_t spooledWakeups;
+    uint32_t avgWakeLatency;
+    uint32_t maxWakeLatency;
+
+    static const uint64_t STATS_WINDOW_US;
+
+    void updateWindow(uint64_t now);
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,123 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// 平台编译期配置：按目标芯片和PSRAM选择缓冲区尺寸
+// 各项均可在 platformio.ini 的 build_flags 中用 -D 覆盖
+
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+  #define BRIDGE_PROFILE_NAME "esp32-psram"
+#elif defined(ESP32)
+  #define BRIDGE_PROFILE_NAME "esp32"
+#else
+  #define BRIDGE_PROFILE_NAME "esp8266"
+#endif
+
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+  // ESP32 + PSRAM (WROVER): 抓包和待发缓冲区放在4MB PSRAM中，
+  // 内部RAM留给更大的帧、行缓冲区和UART驱动缓冲区，适合高波特率长时间运行
+  #ifndef BRIDGE_SERIAL_CHUNK_SIZE
+    #define BRIDGE_SERIAL_CHUNK_SIZE 4096
+  #endif
+  #ifndef BRIDGE_UART_RX_BUFFER
+    #define BRIDGE_UART_RX_BUFFER 16384
+  #endif
+  #ifndef BRIDGE_UART_TX_BUFFER
+    #define BRIDGE_UART_TX_BUFFER 4096
+  #endif
+  #ifndef BRIDGE_FILTER_MAX_LINE
+    #define BRIDGE_FILTER_MAX_LINE 512
+  #endif
+  #ifndef BRIDGE_CAPTURE_CAPACITY
+    #define BRIDGE_CAPTURE_CAPACITY (1024 * 1024)  // PSRAM
+  #endif
+  #ifndef BRIDGE_SPOOL_CAPACITY
+    #define BRIDGE_SPOOL_CAPACITY (1024 * 1024)    // PSRAM
+  #endif
+  #ifndef BRIDGE_RAM_BUDGET
+    #define BRIDGE_RAM_BUDGET (128 * 1024)
+  #endif
+  #ifndef BRIDGE_PSRAM_BUDGET
+    #define BRIDGE_PSRAM_BUDGET (3 * 1024 * 1024)  // 为其他PSRAM用户保留约1MB
+  #endif
+  #define BRIDGE_USE_PSRAM 1
+#elif defined(ESP32)
+  // ESP32: 约320KB内部RAM，用于提高吞吐
+  #ifndef BRIDGE_SERIAL_CHUNK_SIZE
+    #define BRIDGE_SERIAL_CHUNK_SIZE 1024       // 单次从串口读取并打包发送的最大字节数
+  #endif
+  #ifndef BRIDGE_UART_RX_BUFFER
+    #define BRIDGE_UART_RX_BUFFER 4096          // UART驱动接收缓冲区
+  #endif
+  #ifndef BRIDGE_UART_TX_BUFFER
+    #define BRIDGE_UART_TX_BUFFER 1024          // UART驱动发送缓冲区
+  #endif
+  #ifndef BRIDGE_FILTER_MAX_LINE
+    #define BRIDGE_FILTER_MAX_LINE 256          // 行过滤器单行长度
+  #endif
+  #ifndef BRIDGE_CAPTURE_CAPACITY
+    #define BRIDGE_CAPTURE_CAPACITY (32 * 1024) // 抓包缓冲区（内部RAM）
+  #endif
+  #ifndef BRIDGE_SPOOL_CAPACITY
+    #define BRIDGE_SPOOL_CAPACITY (64 * 1024)   // 断线期间暂存串口数据的待发缓冲区
+  #endif
+  #ifndef BRIDGE_RAM_BUDGET
+    #define BRIDGE_RAM_BUDGET (128 * 1024)      // 以上缓冲区占用内部RAM的上限
+  #endif
+  #ifndef BRIDGE_PSRAM_BUDGET
+    #define BRIDGE_PSRAM_BUDGET 0
+  #endif
+  #define BRIDGE_USE_PSRAM 0
+#else
+  // ESP8266: 约50KB可用堆，WiFi/TCP协议栈需要保留大部分
+  #ifndef BRIDGE_SERIAL_CHUNK_SIZE
+    #define BRIDGE_SERIAL_CHUNK_SIZE 256
+  #endif
+  #ifndef BRIDGE_UART_RX_BUFFER
+    #define BRIDGE_UART_RX_BUFFER 512
+  #endif
+  #ifndef BRIDGE_UART_TX_BUFFER
+    #define BRIDGE_UART_TX_BUFFER 0             // ESP8266 只有硬件FIFO，不可配置
+  #endif
+  #ifndef BRIDGE_FILTER_MAX_LINE
+    #define BRIDGE_FILTER_MAX_LINE 128
+  #endif
+  #ifndef BRIDGE_CAPTURE_CAPACITY
+    #define BRIDGE_CAPTURE_CAPACITY (4 * 1024)
+  #endif
+  #ifndef BRIDGE_SPOOL_CAPACITY
+    #define BRIDGE_SPOOL_CAPACITY (4 * 1024)
+  #endif
+  #ifndef BRIDGE_RAM_BUDGET
+    #define BRIDGE_RAM_BUDGET (16 * 1024)
+  #endif
+  #ifndef BRIDGE_PSRAM_BUDGET
+    #define BRIDGE_PSRAM_BUDGET 0
+  #endif
+  #define BRIDGE_USE_PSRAM 0
+#endif
+
+// 抓包和待发缓冲区在堆上分配，按所在位置分别计入内部RAM或PSRAM预算
+#if BRIDGE_USE_PSRAM
+  #define BRIDGE_HEAP_BUFFERS_INTERNAL 0
+  #define BRIDGE_HEAP_BUFFERS_PSRAM (BRIDGE_CAPTURE_CAPACITY + BRIDGE_SPOOL_CAPACITY)
+#else
+  #define BRIDGE_HEAP_BUFFERS_INTERNAL (BRIDGE_CAPTURE_CAPACITY + BRIDGE_SPOOL_CAPACITY)
+  #define BRIDGE_HEAP_BUFFERS_PSRAM 0
+#endif
+
+// 运行期诊断输出（端点超时、切换等）会写入被桥接的串口，干扰目标设备，默认关闭
+// 调试时在 build_flags 中加 -DBRIDGE_DEBUG 启用
+#ifdef BRIDGE_DEBUG
+  #define BRIDGE_LOG(...) Serial.printf(__VA_ARGS__)
+#else
+  #define BRIDGE_LOG(...) do {} while (0)
+#endif
+
+static_assert((BRIDGE_CAPTURE_CAPACITY & (BRIDGE_CAPTURE_CAPACITY - 1)) == 0,
+              "BRIDGE_CAPTURE_CAPACITY must be a power of two");
+static_assert(BRIDGE_HEAP_BUFFERS_PSRAM <= BRIDGE_PSRAM_BUDGET,
+              "PSRAM buffers exceed BRIDGE_PSRAM_BUDGET for this profile");
+static_assert(BRIDGE_FILTER_MAX_LINE >= 32 && BRIDGE_FILTER_MAX_LINE <= 1024,
+              "BRIDGE_FILTER_MAX_LINE out of range");
+
+#endif // PROFILE_H
@@ -0,0 +1,44 @@
+#ifndef SERIAL_RECEIVER_H
+#define SERIAL_RECEIVER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// 串口接收事件：记录数据进入RX路径的时间，并为低功耗模式提供唤醒信号
+//
+// - ESP32：注册 Serial.onReceive，UART驱动把数据交给接收缓冲区时（FIFO达到阈值或
+//   接收超时）记录时间，作为缓冲区中这批数据的采集时间。loop() 被阻塞（如重连）期间
+//   数据在缓冲区中停留的时间因此计入延迟。
+// - ESP8266：没有接收事件，采集时间为 loop() 轮询到数据的时间。
+class SerialReceiver {
+public:
+    SerialReceiver();
+
+    // 注册接收事件（需在 Serial.begin() 之后调用）
+    void begin();
+
+    // 接收缓冲区中待读数据的采集时间，没有记录时返回当前时间
+    // 一次未读完时，剩余数据沿用同一时间（偏早，为上界）
+    uint64_t getCaptureTime() const;
+
+    // 读取串口数据后调用：缓冲区已读空时清除记录
+    void markRead();
+
+#if defined(ESP32)
+    // 阻塞等待接收事件，最长 timeoutMs，返回是否有数据
+    bool waitForData(uint32_t timeoutMs);
+#endif
+
+private:
+    std::atomic<bool> stamped;
+    uint64_t firstRxUs;     // 仅在 stamped 为false时由事件任务写入
+
+#if defined(ESP32)
+    SemaphoreHandle_t stampLock;
+    SemaphoreHandle_t rxSignal;
+
+    void onReceive();
+#endif
+};
+
+#endif // SERIAL_RECEIVER_H
@@ -0,0 +1,52 @@
+#ifndef SPOOL_BUFFER_H
+#define SPOOL_BUFFER_H
+
+#include <Arduino.h>
+
+// 待发数据缓冲区（串口 -> 网络）
+//
+// WebSocket未连接（断线、切换服务器）时，串口数据照常读取并按记录暂存于此，
+// 连接恢复后按顺序补发。每条记录保留首字节的采集时间和帧序号，补发的时间戳帧与
+// 直接发送的相同；被丢弃的记录在服务器端表现为序号缺口。
+// 空间不足时丢弃最旧的记录并计数。仅在loop中使用，无需同步。
+//
+// 记录格式：u64 capture_us | u32 seq | u16 length | data
+class SpoolBuffer {
+public:
+    static const size_t RECORD_HEADER_SIZE = 14;
+
+    SpoolBuffer();
+    ~SpoolBuffer();
+
+    // 分配缓冲区，分配策略见 allocateBuffer()
+    bool begin(size_t capacity, bool usePsram);
+
+    bool isEnabled() const;
+    bool isEmpty() const;
+    size_t getUsed() const;
+    size_t getCapacity() const;
+    uint32_t getDroppedBytes() const;
+
+    // 追加一段待发数据，空间不足时丢弃最旧的记录；数据本身放不下时返回false
+    bool push(const uint8_t* data, size_t len, uint32_t sequence, uint64_t captureUs);
+
+    // 读取最旧的一条记录（不移除），返回数据长度，空时返回0
+    // 记录长度超过 maxLen 时将其丢弃并继续读取下一条
+    size_t peek(uint8_t* out, size_t maxLen, uint32_t& sequence, uint64_t& captureUs);
+
+    // 移除最旧的一条记录（发送成功后调用）
+    void pop();
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t readPos;
+    size_t used;
+    uint32_t droppedBytes;
+
+    size_t recordLength(size_t position) const;
+    void copyIn(size_t position, const uint8_t* data, size_t len);
+    void copyOut(size_t position, uint8_t* out, size_t len) const;
+};
+
+#endif // SPOOL_BUFFER_H
@@ -0,0 +1,165 @@
+#include "CaptureRing.h"
+#include "BufferUtil.h"
+
+CaptureRing::CaptureRing() : buffer(nullptr), mask(0), head(0), tail(0) {
+}
+
+CaptureRing::~CaptureRing() {
+    free(buffer);
+}
+
+bool CaptureRing::begin(size_t capacity, bool usePsram) {
+    // 容量取2的幂，位置用32位累计值，回绕时取模仍然连续
+    size_t size = 1;
+    while (size * 2 <= capacity) {
+        size *= 2;
+    }
+    if (size < RECORD_HEADER_SIZE + MAX_RECORD_DATA) {
+        return false;
+    }
+
+    buffer = allocateBuffer("Capture", size, usePsram);
+    if (!buffer) {
+        return false;
+    }
+
+    mask = size - 1;
+    head.store(0);
+    tail.store(0);
+    return true;
+}
+
+bool CaptureRing::isEnabled() const {
+    return buffer != nullptr;
+}
+
+size_t CaptureRing::getCapacity() const {
+    return buffer ? mask + 1 : 0;
+}
+
+void CaptureRing::append(Direction direction, const uint8_t* data, size_t len, uint64_t timestampUs) {
+    if (!buffer) {
+        return;
+    }
+    while (len > 0) {
+        size_t chunk = min(len, (size_t)MAX_RECORD_DATA);
+        appendRecord(direction, data, chunk, timestampUs);
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void CaptureRing::appendRecord(Direction direction, const uint8_t* data, size_t len, uint64_t timestampUs) {
+    uint32_t recordSize = RECORD_HEADER_SIZE + len;
+    uint32_t writePos = head.load(std::memory_order_relaxed);
+    uint32_t oldest = tail.load(std::memory_order_relaxed);
+
+    // 淘汰最旧的记录直到有足够空间
+    if (writePos + recordSize - oldest > mask + 1) {
+        while (writePos + recordSize - oldest > mask + 1) {
+            uint8_t lengthField[2];
+            copyOut(oldest + 6, lengthField, 2);
+            oldest += RECORD_HEADER_SIZE + ((lengthField[0] | (lengthField[1] << 8)) & 0x7FFF);
+        }
+        // 先发布新的tail再覆盖数据，读取端据此判断拷贝是否有效
+        tail.store(oldest, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    uint64_t timestampMs = timestampUs / 1000;
+    uint8_t header[RECORD_HEADER_SIZE];
+    putLE(header, timestampMs, 4);
+    putLE(header + 4, timestampUs - timestampMs * 1000, 2);
+    putLE(header + 6, len | (direction == DIR_NET_TO_SERIAL ? 0x8000 : 0), 2);
+
+    copyIn(writePos, header, RECORD_HEADER_SIZE);
+    copyIn(writePos + RECORD_HEADER_SIZE, data, len);
+    head.store(writePos + recordSize, std::memory_order_release);
+}
+
+void CaptureRing::copyIn(uint32_t position, const uint8_t* data, size_t len) {
+    ringWrite(buffer, mask + 1, position & mask, data, len);
+}
+
+void CaptureRing::copyOut(uint32_t position, uint8_t* out, size_t len) const {
+    ringRead(buffer, mask + 1, position & mask, out, len);
+}
+
+CaptureRing::Reader CaptureRing::openReader(uint64_t nowUs, int64_t clockOffset, bool synced) const {
+    Reader reader;
+    reader.end = head.load(std::memory_order_acquire);
+    reader.cursor = tail.load(std::memory_order_acquire);
+    reader.headerSent = false;
+    reader.synced = synced;
+    reader.openedUs = nowUs;
+    reader.clockOffset = clockOffset;
+    return reader;
+}
+
+bool CaptureRing::isDone(const Reader& reader) const {
+    return reader.headerSent && reader.cursor == reader.end;
+}
+
+size_t CaptureRing::read(Reader& reader, uint8_t* out, size_t maxLen) const {
+    size_t written = 0;
+
+    if (!reader.headerSent) {
+        if (maxLen < FILE_HEADER_SIZE) {
+            return 0;
+        }
+        memcpy(out, "SCAP", 4);
+        out[4] = 1;
+        out[5] = reader.synced ? 0x01 : 0;
+        putLE(out + 6, 0, 2);
+        putLE(out + 8, reader.openedUs, 8);
+        putLE(out + 16, (uint64_t)reader.clockOffset, 8);
+        written = FILE_HEADER_SIZE;
+        reader.headerSent = true;
+    }
+
+    if (!buffer) {
+        reader.cursor = reader.end;
+        return written;
+    }
+
+    while (reader.cursor != reader.end) {
+        // 落后于写入端时跳到最旧的有效记录（记录边界）
+        uint32_t oldest = tail.load(std::memory_order_acquire);
+        if ((int32_t)(reader.cursor - oldest) < 0) {
+            reader.cursor = oldest;
+        }
+        if ((int32_t)(reader.end - reader.cursor) <= 0) {
+            reader.cursor = reader.end;
+            break;
+        }
+
+        uint8_t header[RECORD_HEADER_SIZE];
+        copyOut(reader.cursor, header, RECORD_HEADER_SIZE);
+        size_t len = (header[6] | (header[7] << 8)) & 0x7FFF;
+        size_t recordSize = RECORD_HEADER_SIZE + len;
+
+        bool valid = len <= MAX_RECORD_DATA;
+        if (valid) {
+            if (written + recordSize > maxLen) {
+                break;
+            }
+            memcpy(out + written, header, RECORD_HEADER_SIZE);
+            copyOut(reader.cursor + RECORD_HEADER_SIZE, out + written + RECORD_HEADER_SIZE, len);
+        }
+
+        // 拷贝期间被覆盖则丢弃本次拷贝，下一轮从新的tail重新开始
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((int32_t)(reader.cursor - tail.load(std::memory_order_relaxed)) < 0) {
+            continue;
+        }
+        if (!valid) {
+            reader.cursor = reader.end;
+            break;
+        }
+
+        written += recordSize;
+        reader.cursor += recordSize;
+    }
+
+    return written;
+}
@@ -4,6 +4,11 @@
 const char* ConfigManager::NAMESPACE = "device_config";
 const char* ConfigManager::CONFIG_VERSION = "v1.0"; // Change this to force config reset
 
+// 第一个服务器沿用旧的键名 "ws_url"，其余为 "ws_url1"、"ws_url2" 等
+String ConfigManager::urlKey(size_t index) {
+    return index == 0 ? String("ws_url") : "ws_url" + String(index);
+}
+
 ConfigManager::ConfigManager() {
     config = getDefaultConfig();
 }
@@ -12,9 +17,16 @@ DeviceConfig ConfigManager::getDefaultConfig() {
     DeviceConfig defaultConfig;
     strcpy(defaultConfig.wifi_ssid, "");
     strcpy(defaultConfig.wifi_password, "");
-    strcpy(defaultConfig.websocket_url, "ws://192.168.1.100/ws");
+    strcpy(defaultConfig.websocket_urls[0], "ws://192.168.1.100/ws");
+    for (size_t i = 1; i < MAX_WS_ENDPOINTS; i++) {
+        strcpy(defaultConfig.websocket_urls[i], "");
+    }
     defaultConfig.serial_baud_rate = 115200;
     defaultConfig.simulate_serial = false;
+    defaultConfig.timestamp_frames = false;
+    strcpy(defaultConfig.ntp_server, "pool.ntp.org");
+    strcpy(defaultConfig.filter_rules, "");
+    defaultConfig.power_save = false;
     defaultConfig.configured = false;
     return defaultConfig;
 }
@@ -51,17 +63,29 @@ bool ConfigManager::loadConfig() {
     // 加载配置
     preferences.getString("wifi_ssid", config.wifi_ssid, sizeof(config.wifi_ssid));
     preferences.getString("wifi_pwd", config.wifi_password, sizeof(config.wifi_password));
-    preferences.getString("ws_url", config.websocket_url, sizeof(config.websocket_url));
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        preferences.getString(urlKey(i).c_str(), "").toCharArray(config.websocket_urls[i], sizeof(config.websocket_urls[i]));
+    }
     config.serial_baud_rate = preferences.getUInt("baud_rate", 115200);
     config.simulate_serial = preferences.getBool("sim_serial", false);
+    config.timestamp_frames = preferences.getBool("ts_frames", false);
+    preferences.getString("ntp_server", "pool.ntp.org").toCharArray(config.ntp_server, sizeof(config.ntp_server));
+    preferences.getString("filter", "").toCharArray(config.filter_rules, sizeof(config.filter_rules));
+    config.power_save = preferences.getBool("power_save", false);
     
     preferences.end();
     
     Serial.println("Configuration loaded successfully");
     Serial.printf("WiFi SSID: %s\n", config.wifi_ssid);
-    Serial.printf("WebSocket URL: %s\n", config.websocket_url);
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        if (strlen(config.websocket_urls[i]) > 0) {
+            Serial.printf("WebSocket URL [%u]: %s\n", (unsigned)i, config.websocket_urls[i]);
+        }
+    }
     Serial.printf("Baud Rate: %d\n", config.serial_baud_rate);
     Serial.printf("Simulate Serial: %s\n", config.simulate_serial ? "Yes" : "No");
+    Serial.printf("Timestamp Frames: %s\n", config.timestamp_frames ? "Yes" : "No");
+    Serial.printf("Power Save: %s\n", config.power_save ? "Yes" : "No");
     
     return true;
 }
@@ -78,9 +102,15 @@ bool ConfigManager::saveConfig(const DeviceConfig& newConfig) {
     preferences.putString("version", CONFIG_VERSION); // Ensure version is saved
     preferences.putString("wifi_ssid", newConfig.wifi_ssid);
     preferences.putString("wifi_pwd", newConfig.wifi_password);
-    preferences.putString("ws_url", newConfig.websocket_url);
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        preferences.putString(urlKey(i).c_str(), newConfig.websocket_urls[i]);
+    }
     preferences.putUInt("baud_rate", newConfig.serial_baud_rate);
     preferences.putBool("sim_serial", newConfig.simulate_serial);
+    preferences.putBool("ts_frames", newConfig.timestamp_frames);
+    preferences.putString("ntp_server", newConfig.ntp_server);
+    preferences.putString("filter", newConfig.filter_rules);
+    preferences.putBool("power_save", newConfig.power_save);
     preferences.putBool("configured", true);
     
     preferences.end();
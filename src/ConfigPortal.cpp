@@ -1,4 +1,6 @@
 #include "ConfigPortal.h"
+#include "LineFilter.h"
+#include <memory>
 
 const char* ConfigPortal::AP_SSID = "ESP32-Config";
 const char* ConfigPortal::AP_PASSWORD = "";  // 无密码
@@ -63,6 +65,19 @@ void ConfigPortal::setupRoutes() {
 String ConfigPortal::generateConfigPage() {
     DeviceConfig currentConfig = configManager->getConfig();
     
+    // 服务器列表输入框，第一个沿用原字段名
+    String endpointInputs;
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        String name = i == 0 ? String("websocket_url") : "websocket_url_" + String(i);
+        endpointInputs += "\n                <input type=\"text\" id=\"" + name + "\" name=\"" + name + "\"";
+        endpointInputs += " value=\"" + String(currentConfig.websocket_urls[i]) + "\" maxlength=\"127\"";
+        if (i == 0) {
+            endpointInputs += " placeholder=\"首选服务器\">";
+        } else {
+            endpointInputs += " placeholder=\"备用服务器 " + String(i) + "\" style=\"margin-top: 8px;\">";
+        }
+    }
+    
     String html = R"rawliteral(
 <!DOCTYPE html>
 <html lang="zh-CN">
@@ -125,7 +140,18 @@ String ConfigPortal::generateConfigPage() {
             font-size: 14px;
             transition: all 0.3s;
         }
-        input:focus {
+        textarea {
+            width: 100%;
+            padding: 12px;
+            border: 2px solid #e0e0e0;
+            border-radius: 8px;
+            font-size: 13px;
+            font-family: monospace;
+            resize: vertical;
+            transition: all 0.3s;
+        }
+        input:focus,
+        textarea:focus {
             outline: none;
             border-color: #667eea;
             box-shadow: 0 0 0 3px rgba(102, 126, 234, 0.1);
@@ -197,11 +223,8 @@ String ConfigPortal::generateConfigPage() {
             </div>
             
             <div class="form-group">
-                <label for="websocket_url">WebSocket URL</label>
-                <input type="text" id="websocket_url" name="websocket_url" 
-                       value=")rawliteral" + String(currentConfig.websocket_url) + R"rawliteral(" 
-                       maxlength="127">
-                <div class="hint">例如: ws://192.168.1.100/ws</div>
+                <label for="websocket_url">WebSocket URL</label>)rawliteral" + endpointInputs + R"rawliteral(
+                <div class="hint">例如: ws://192.168.1.100/ws；可按优先级填写多个服务器，自动选择延迟最低的可用服务器并在故障时切换</div>
             </div>
             
             <div class="form-group">
@@ -221,6 +244,41 @@ String ConfigPortal::generateConfigPage() {
                 </label>
                 <div class="hint">开启后将生成随机数据发送到WebSocket，不读取实际串口</div>
             </div>
+
+            <div class="form-group">
+                <label style="display: flex; align-items: center; cursor: pointer;">
+                    <input type="checkbox" id="timestamp_frames" name="timestamp_frames" 
+                           value="true" )rawliteral" + String(currentConfig.timestamp_frames ? "checked" : "") + R"rawliteral(
+                           style="width: auto; margin-right: 10px;">
+                    启用时间戳帧（延迟追踪）
+                </label>
+                <div class="hint">开启后串口数据以带采集/发送时间戳和序号的二进制帧发送</div>
+            </div>
+
+            <div class="form-group">
+                <label for="ntp_server">NTP 服务器</label>
+                <input type="text" id="ntp_server" name="ntp_server" 
+                       value=")rawliteral" + String(currentConfig.ntp_server) + R"rawliteral(" 
+                       maxlength="63">
+                <div class="hint">用于计算设备时钟偏移，留空则不同步</div>
+            </div>
+
+            <div class="form-group">
+                <label style="display: flex; align-items: center; cursor: pointer;">
+                    <input type="checkbox" id="power_save" name="power_save" 
+                           value="true" )rawliteral" + String(currentConfig.power_save ? "checked" : "") + R"rawliteral(
+                           style="width: auto; margin-right: 10px;">
+                    启用低功耗模式
+                </label>
+                <div class="hint">空闲时休眠等待串口数据，适用于电池/太阳能供电；网络下行延迟最多增加10ms</div>
+            </div>
+
+            <div class="form-group">
+                <label for="filter_rules">串口行过滤规则</label>
+                <textarea id="filter_rules" name="filter_rules" rows="4" maxlength="255"
+                          placeholder="+ERR ctx=2&#10;-DBG&#10;+*panic rate=5">)rawliteral" + String(currentConfig.filter_rules) + R"rawliteral(</textarea>
+                <div class="hint">每行一条：+转发 / -丢弃，*开头为包含匹配，?匹配任意字符，可选 rate=每秒行数 ctx=上下文行数；留空则全部转发</div>
+            </div>
             
             <button type="submit">💾 保存配置</button>
         </form>
@@ -236,7 +294,12 @@ String ConfigPortal::generateConfigPage() {
                 method: 'POST',
                 body: new URLSearchParams(formData)
             })
-            .then(response => response.text())
+            .then(response => {
+                if (!response.ok) {
+                    return response.text().then(text => { throw new Error(text); });
+                }
+                return response.text();
+            })
             .then(data => {
                 document.getElementById('configForm').style.display = 'none';
                 document.getElementById('successMessage').style.display = 'block';
@@ -253,7 +316,7 @@ String ConfigPortal::generateConfigPage() {
                 }, 1000);
             })
             .catch(error => {
-                alert('保存失败: ' + error);
+                alert('保存失败: ' + error.message);
             });
         });
     </script>
@@ -280,9 +343,15 @@ void ConfigPortal::handleConfigSubmit(AsyncWebServerRequest* request) {
         password.toCharArray(newConfig.wifi_password, sizeof(newConfig.wifi_password));
     }
     
-    if (request->hasParam("websocket_url", true)) {
-        String url = request->getParam("websocket_url", true)->value();
-        url.toCharArray(newConfig.websocket_url, sizeof(newConfig.websocket_url));
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        String name = i == 0 ? String("websocket_url") : "websocket_url_" + String(i);
+        if (request->hasParam(name, true)) {
+            String url = request->getParam(name, true)->value();
+            url.trim();
+            url.toCharArray(newConfig.websocket_urls[i], sizeof(newConfig.websocket_urls[i]));
+        } else {
+            newConfig.websocket_urls[i][0] = '\0';
+        }
     }
     
     if (request->hasParam("baud_rate", true)) {
@@ -294,6 +363,45 @@ void ConfigPortal::handleConfigSubmit(AsyncWebServerRequest* request) {
     } else {
         newConfig.simulate_serial = false;
     }
+
+    if (request->hasParam("timestamp_frames", true)) {
+        newConfig.timestamp_frames = request->getParam("timestamp_frames", true)->value() == "true";
+    } else {
+        newConfig.timestamp_frames = false;
+    }
+
+    if (request->hasParam("ntp_server", true)) {
+        String ntpServer = request->getParam("ntp_server", true)->value();
+        ntpServer.toCharArray(newConfig.ntp_server, sizeof(newConfig.ntp_server));
+    } else {
+        newConfig.ntp_server[0] = '\0';
+    }
+
+    if (request->hasParam("power_save", true)) {
+        newConfig.power_save = request->getParam("power_save", true)->value() == "true";
+    } else {
+        newConfig.power_save = false;
+    }
+
+    if (request->hasParam("filter_rules", true)) {
+        String rules = request->getParam("filter_rules", true)->value();
+        // 浏览器以CRLF提交换行，统一为LF以免超出存储长度
+        rules.replace("\r\n", "\n");
+        if (rules.length() >= sizeof(newConfig.filter_rules)) {
+            request->send(400, "text/plain", "过滤规则过长（最多" + String(sizeof(newConfig.filter_rules) - 1) + "字节）");
+            return;
+        }
+        rules.toCharArray(newConfig.filter_rules, sizeof(newConfig.filter_rules));
+        
+        // 启动时规则无效会使过滤器失效（全部转发），因此在保存前检查
+        std::unique_ptr<LineFilter> validator(new LineFilter());
+        if (!validator->compile(newConfig.filter_rules)) {
+            request->send(400, "text/plain", "过滤规则无效，请检查语法");
+            return;
+        }
+    } else {
+        newConfig.filter_rules[0] = '\0';
+    }
     
     newConfig.configured = true;
     
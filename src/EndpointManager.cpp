@@ -0,0 +1,275 @@
+#include "EndpointManager.h"
+#include "Profile.h"
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+  #include <ESPAsyncTCP.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+  #include <AsyncTCP.h>
+#endif
+
+const uint32_t EndpointManager::UNKNOWN_LATENCY_MS = 250;     // 尚无样本的端点按此延迟计算
+const uint32_t EndpointManager::PRIORITY_PENALTY_MS = 50;     // 列表中每靠后一位增加的得分
+const uint32_t EndpointManager::SWITCH_MARGIN_MS = 20;        // 已连接时，新端点得分需低出此值才切换
+const unsigned long EndpointManager::BASE_BACKOFF_MS = 10000;
+const unsigned long EndpointManager::MAX_BACKOFF_MS = 300000;
+
+EndpointManager::EndpointManager()
+    : count(0), current(-1), probeCursor(0), probeIndex(-1), probeStart(0),
+      probeState(PROBE_IDLE), probeClientBusy(false), probeConnectedAt(0) {
+}
+
+size_t EndpointManager::begin(const DeviceConfig& config) {
+    count = 0;
+    current = -1;
+    probeCursor = 0;
+
+    for (size_t i = 0; i < MAX_WS_ENDPOINTS; i++) {
+        if (strlen(config.websocket_urls[i]) == 0) {
+            continue;
+        }
+        Endpoint& endpoint = endpoints[count++];
+        endpoint.url = config.websocket_urls[i];
+        endpoint.latency = 0;
+        endpoint.failures = 0;
+        endpoint.retryAt = 0;
+    }
+    return count;
+}
+
+size_t EndpointManager::getCount() const {
+    return count;
+}
+
+const char* EndpointManager::getUrl(int index) const {
+    return endpoints[index].url;
+}
+
+int EndpointManager::getCurrent() const {
+    return current;
+}
+
+void EndpointManager::setCurrent(int index) {
+    current = index;
+}
+
+bool EndpointManager::isHealthy(int index) const {
+    return endpoints[index].failures < FAILURE_THRESHOLD;
+}
+
+bool EndpointManager::isEligible(int index) const {
+    return isHealthy(index) || (long)(millis() - endpoints[index].retryAt) >= 0;
+}
+
+uint32_t EndpointManager::getLatency(int index) const {
+    return endpoints[index].latency;
+}
+
+uint8_t EndpointManager::getFailures(int index) const {
+    return endpoints[index].failures;
+}
+
+uint32_t EndpointManager::score(int index) const {
+    const Endpoint& endpoint = endpoints[index];
+    uint32_t latency = endpoint.latency > 0 ? endpoint.latency : UNKNOWN_LATENCY_MS;
+    return latency + index * PRIORITY_PENALTY_MS;
+}
+
+int EndpointManager::selectBest() const {
+    int best = -1;
+
+    // 优先健康端点，其次退避已结束的端点，按得分选择
+    for (size_t i = 0; i < count; i++) {
+        if (!isEligible(i)) {
+            continue;
+        }
+        if (best < 0
+            || (isHealthy(i) && !isHealthy(best))
+            || (isHealthy(i) == isHealthy(best) && score(i) < score(best))) {
+            best = i;
+        }
+    }
+
+    // 全部处于退避中：选择最早可重试的端点
+    if (best < 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (best < 0 || (long)(endpoints[i].retryAt - endpoints[best].retryAt) < 0) {
+                best = i;
+            }
+        }
+    }
+    return best;
+}
+
+int EndpointManager::selectSwitchTarget() const {
+    if (count == 0) {
+        return -1;
+    }
+
+    int best = selectBest();
+    if (current < 0) {
+        return best;
+    }
+    if (best == current) {
+        return -1;
+    }
+
+    // 当前端点不健康时立即切换（故障切换）；否则需明显更优（回切/延迟优化）
+    if (!isHealthy(current) && (isHealthy(best) || isEligible(best))) {
+        return best;
+    }
+    if (isHealthy(best) && score(best) + SWITCH_MARGIN_MS < score(current)) {
+        return best;
+    }
+    return -1;
+}
+
+void EndpointManager::recordSuccess(int index) {
+    if (index < 0) {
+        return;
+    }
+    endpoints[index].failures = 0;
+}
+
+void EndpointManager::recordFailure(int index) {
+    if (index < 0) {
+        return;
+    }
+    Endpoint& endpoint = endpoints[index];
+    if (endpoint.failures < 255) {
+        endpoint.failures++;
+    }
+
+    if (endpoint.failures >= FAILURE_THRESHOLD) {
+        // 指数退避
+        uint8_t shift = min(endpoint.failures - FAILURE_THRESHOLD, 5);
+        unsigned long backoff = min(BASE_BACKOFF_MS << shift, MAX_BACKOFF_MS);
+        endpoint.retryAt = millis() + backoff;
+        BRIDGE_LOG("[WSc] Endpoint %d unhealthy, retry in %lus\n", index, backoff / 1000);
+    }
+}
+
+void EndpointManager::recordLatency(int index, uint32_t latencyMs) {
+    if (index < 0) {
+        return;
+    }
+    Endpoint& endpoint = endpoints[index];
+    // 移动平均 (1/4)，避免单次抖动引起切换
+    endpoint.latency = endpoint.latency == 0 ? latencyMs : (endpoint.latency * 3 + latencyMs) / 4;
+    if (endpoint.latency == 0) {
+        endpoint.latency = 1;
+    }
+}
+
+int EndpointManager::startProbe() {
+    if (probeState.load() != PROBE_IDLE || probeClientBusy.load()) {
+        return -1;
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        int index = probeCursor;
+        probeCursor = (probeCursor + 1) % count;
+        if (index == current || !isEligible(index)) {
+            continue;
+        }
+
+        String host;
+        int port = 80;
+        String path;
+        parseUrl(endpoints[index].url, host, port, path);
+
+        // 回调在TCP任务中执行；连接对象由 onDisconnect 释放，发起连接后loop不再访问它
+        AsyncClient* client = new AsyncClient();
+        client->onConnect([this](void*, AsyncClient* c) {
+            probeConnectedAt.store(millis());
+            uint8_t expected = PROBE_PENDING;
+            probeState.compare_exchange_strong(expected, (uint8_t)PROBE_CONNECTED);
+            c->close(true);
+        });
+        client->onError([this](void*, AsyncClient*, int8_t) {
+            uint8_t expected = PROBE_PENDING;
+            probeState.compare_exchange_strong(expected, (uint8_t)PROBE_FAILED);
+        });
+        client->onDisconnect([this](void*, AsyncClient* c) {
+            probeClientBusy.store(false);
+            delete c;
+        });
+
+        probeIndex = index;
+        probeStart = millis();
+        probeState.store(PROBE_PENDING);
+        probeClientBusy.store(true);
+        if (!client->connect(host.c_str(), port)) {
+            // 未能发起连接（如DNS请求失败），不会再有回调
+            delete client;
+            probeClientBusy.store(false);
+            probeState.store(PROBE_FAILED);
+        }
+        return index;
+    }
+    return -1;
+}
+
+void EndpointManager::updateProbe() {
+    uint8_t state = probeState.load();
+    if (state == PROBE_IDLE) {
+        return;
+    }
+    if (state == PROBE_PENDING) {
+        unsigned long elapsed = millis() - probeStart;
+        if (elapsed < PROBE_TIMEOUT_MS) {
+            return;
+        }
+        // 超时：端点可能只是慢，按耗时记为延迟以降低其得分，只有连接出错才记失败
+        // 若回调恰好同时完成，以回调结果为准
+        if (probeState.compare_exchange_strong(state, (uint8_t)PROBE_IDLE)) {
+            recordLatency(probeIndex, elapsed);
+            return;
+        }
+    }
+
+    if (state == PROBE_CONNECTED) {
+        recordSuccess(probeIndex);
+        recordLatency(probeIndex, probeConnectedAt.load() - probeStart);
+    } else {
+        recordFailure(probeIndex);
+    }
+    probeState.store(PROBE_IDLE);
+}
+
+void EndpointManager::parseUrl(const char* url, String& host, int& port, String& path) {
+    String urlStr = String(url);
+
+    // Remove ws:// or wss://
+    if (urlStr.startsWith("ws://")) {
+        urlStr = urlStr.substring(5);
+        port = 80;
+    } else if (urlStr.startsWith("wss://")) {
+        urlStr = urlStr.substring(6);
+        port = 443;
+    }
+
+    int firstSlash = urlStr.indexOf('/');
+    int firstColon = urlStr.indexOf(':');
+
+    if (firstColon != -1 && (firstSlash == -1 || firstColon < firstSlash)) {
+        // Has port
+        host = urlStr.substring(0, firstColon);
+        if (firstSlash != -1) {
+            port = urlStr.substring(firstColon + 1, firstSlash).toInt();
+            path = urlStr.substring(firstSlash);
+        } else {
+            port = urlStr.substring(firstColon + 1).toInt();
+            path = "/";
+        }
+    } else {
+        // No port
+        if (firstSlash != -1) {
+            host = urlStr.substring(0, firstSlash);
+            path = urlStr.substring(firstSlash);
+        } else {
+            host = urlStr;
+            path = "/";
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "FrameStamper.h"
+#include "BufferUtil.h"
+#include <time.h>
+#include <sys/time.h>
+#if defined(ESP32)
+  #include <esp_timer.h>
+#endif
+
+const uint8_t FrameStamper::VERSION = 1;
+const uint8_t FrameStamper::FLAG_SYNCED = 0x01;
+const unsigned long FrameStamper::SYNC_RETRY_INTERVAL = 2000;    // 未同步时每2秒检查一次
+const unsigned long FrameStamper::SYNC_REFRESH_INTERVAL = 60000; // 同步后每分钟刷新偏移（SNTP会微调系统时间）
+
+// 早于此时间的系统时间视为未同步 (2020-09-13)
+static const time_t MIN_VALID_EPOCH = 1600000000;
+
+FrameStamper::FrameStamper()
+    : sequence(0), clockOffset(0), synced(false), sntpEnabled(false), lastSyncCheck(0) {
+}
+
+void FrameStamper::begin(const char* ntpServer) {
+    sequence = 0;
+    synced = false;
+    clockOffset = 0;
+    sntpEnabled = ntpServer && strlen(ntpServer) > 0;
+
+    if (sntpEnabled) {
+        // 使用UTC，时区由服务器端处理
+        configTime(0, 0, ntpServer);
+        Serial.printf("SNTP server: %s\n", ntpServer);
+    }
+    lastSyncCheck = millis();
+}
+
+void FrameStamper::update() {
+    if (!sntpEnabled) {
+        return;
+    }
+
+    unsigned long interval = synced ? SYNC_REFRESH_INTERVAL : SYNC_RETRY_INTERVAL;
+    if (millis() - lastSyncCheck < interval) {
+        return;
+    }
+    lastSyncCheck = millis();
+
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < MIN_VALID_EPOCH) {
+        return;
+    }
+
+    int64_t epochUs = (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+    clockOffset = epochUs - (int64_t)nowMicros();
+
+    if (!synced) {
+        synced = true;
+        Serial.println("Clock synchronized via SNTP");
+    }
+}
+
+uint64_t FrameStamper::nowMicros() {
+#if defined(ESP8266)
+    return micros64();
+#else
+    return (uint64_t)esp_timer_get_time();
+#endif
+}
+
+bool FrameStamper::isSynced() const {
+    return synced;
+}
+
+int64_t FrameStamper::getClockOffset() const {
+    return clockOffset;
+}
+
+uint32_t FrameStamper::nextSequence() {
+    return sequence++;
+}
+
+void FrameStamper::writeHeader(uint8_t* header, uint32_t frameSequence, uint64_t captureUs) {
+    header[0] = 'S';
+    header[1] = 'B';
+    header[2] = VERSION;
+    header[3] = synced ? FLAG_SYNCED : 0;
+    putLE(header + 4, frameSequence, 4);
+    putLE(header + 8, captureUs, 8);
+    putLE(header + 16, nowMicros(), 8);
+    putLE(header + 24, (uint64_t)clockOffset, 8);
+}
@@ -0,0 +1,323 @@
+#include "LineFilter.h"
+
+static bool matchAt(const uint8_t* text, const char* pattern, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (pattern[i] != '?' && (uint8_t)pattern[i] != text[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解析十进制整数选项值，非数字、有多余字符或超出范围时返回false
+static bool parseCount(const char* text, long minValue, long maxValue, long& value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char* end = nullptr;
+    value = strtol(text, &end, 10);
+    return *end == '\0' && value >= minValue && value <= maxValue;
+}
+
+LineFilter::LineFilter() {
+    reset();
+}
+
+void LineFilter::reset() {
+    rulesText[0] = '\0';
+    ruleCount = 0;
+    memset(firstByteRules, 0, sizeof(firstByteRules));
+    containsRules = 0;
+    hasForwardRules = false;
+    maxContext = 0;
+    lineLength = 0;
+    lineCaptureUs = 0;
+    historyHead = 0;
+    historyCount = 0;
+    afterContext = 0;
+    forwardedLines = 0;
+    droppedLines = 0;
+}
+
+bool LineFilter::compile(const char* text) {
+    reset();
+    if (!text) {
+        return true;
+    }
+
+    strncpy(rulesText, text, sizeof(rulesText) - 1);
+    rulesText[sizeof(rulesText) - 1] = '\0';
+
+    char* p = rulesText;
+    while (*p) {
+        char* end = p + strcspn(p, "\r\n");
+        bool last = (*end == '\0');
+        *end = '\0';
+
+        if (!parseRule(p)) {
+            Serial.printf("Invalid filter rule: %s\n", p);
+            reset();
+            return false;
+        }
+
+        p = last ? end : end + 1;
+    }
+
+    if (ruleCount > 0) {
+        Serial.printf("Line filter: %u rules compiled\n", (unsigned)ruleCount);
+    }
+    return true;
+}
+
+bool LineFilter::parseRule(char* text) {
+    while (*text == ' ' || *text == '\t') {
+        text++;
+    }
+    if (*text == '\0' || *text == '#') {
+        return true;
+    }
+    if ((*text != '+' && *text != '-') || ruleCount >= MAX_RULES) {
+        return false;
+    }
+
+    Rule& rule = rules[ruleCount];
+    rule.forward = (*text == '+');
+    text++;
+    rule.contains = (*text == '*');
+    if (rule.contains) {
+        text++;
+    }
+
+    // 模式到第一个空格为止，其后为选项
+    size_t patternLength = strcspn(text, " \t");
+    if (patternLength >= MAX_LINE) {
+        return false;
+    }
+    rule.pattern = text;
+    rule.patternLength = patternLength;
+    rule.context = 0;
+    rule.ratePerSecond = 0;
+    rule.windowCount = 0;
+    rule.windowStart = 0;
+
+    char* option = text + patternLength;
+    if (*option) {
+        *option++ = '\0';
+    }
+    while (*option) {
+        size_t optionLength = strcspn(option, " \t");
+        char* next = option + optionLength;
+        if (*next) {
+            *next++ = '\0';
+        }
+
+        long value = 0;
+        if (strncmp(option, "rate=", 5) == 0) {
+            if (!parseCount(option + 5, 1, 0xFFFF, value)) {
+                return false;
+            }
+            rule.ratePerSecond = value;
+        } else if (strncmp(option, "ctx=", 4) == 0) {
+            if (!parseCount(option + 4, 0, MAX_CONTEXT, value)) {
+                return false;
+            }
+            rule.context = value;
+        } else if (optionLength > 0) {
+            return false;
+        }
+        option = next;
+    }
+
+    uint16_t bit = 1 << ruleCount;
+    if (rule.contains) {
+        containsRules |= bit;
+    } else if (rule.patternLength == 0 || rule.pattern[0] == '?') {
+        for (size_t c = 0; c < 256; c++) {
+            firstByteRules[c] |= bit;
+        }
+    } else {
+        firstByteRules[(uint8_t)rule.pattern[0]] |= bit;
+    }
+
+    if (rule.forward) {
+        hasForwardRules = true;
+    }
+    if (rule.context > maxContext) {
+        maxContext = rule.context;
+    }
+
+    ruleCount++;
+    return true;
+}
+
+bool LineFilter::isActive() const {
+    return ruleCount > 0;
+}
+
+bool LineFilter::hasPending() const {
+    return lineLength > 0;
+}
+
+uint32_t LineFilter::getForwardedLines() const {
+    return forwardedLines;
+}
+
+uint32_t LineFilter::getDroppedLines() const {
+    return droppedLines;
+}
+
+size_t LineFilter::feed(const uint8_t* data, size_t len, uint64_t captureUs, uint8_t* out, uint64_t& firstCaptureUs) {
+    size_t written = 0;
+
+    while (len > 0) {
+        size_t take = min(len, MAX_LINE - lineLength);
+        const uint8_t* newline = (const uint8_t*)memchr(data, '\n', take);
+        if (newline) {
+            take = newline - data + 1;
+        }
+
+        if (lineLength == 0) {
+            lineCaptureUs = captureUs;
+        }
+        memcpy(line + lineLength, data, take);
+        lineLength += take;
+        data += take;
+        len -= take;
+
+        if (newline || lineLength == MAX_LINE) {
+            uint64_t lineUs = 0;
+            size_t count = processLine(out + written, lineUs);
+            if (written == 0 && count > 0) {
+                firstCaptureUs = lineUs;
+            }
+            written += count;
+        }
+    }
+
+    return written;
+}
+
+size_t LineFilter::flush(uint8_t* out, uint64_t& captureUs) {
+    if (lineLength == 0) {
+        return 0;
+    }
+    uint64_t lineUs = 0;
+    size_t count = processLine(out, lineUs);
+    if (count > 0) {
+        captureUs = lineUs;
+    }
+    return count;
+}
+
+bool LineFilter::ruleMatches(const Rule& rule) const {
+    if (lineLength < rule.patternLength) {
+        return false;
+    }
+    if (!rule.contains) {
+        return matchAt(line, rule.pattern, rule.patternLength);
+    }
+    for (size_t offset = 0; offset + rule.patternLength <= lineLength; offset++) {
+        if (matchAt(line + offset, rule.pattern, rule.patternLength)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int LineFilter::findRule() const {
+    uint16_t candidates = firstByteRules[line[0]] | containsRules;
+
+    for (size_t i = 0; candidates != 0 && i < ruleCount; i++) {
+        uint16_t bit = 1 << i;
+        if ((candidates & bit) && ruleMatches(rules[i])) {
+            return i;
+        }
+        candidates &= ~bit;
+    }
+    return -1;
+}
+
+bool LineFilter::allowRate(Rule& rule) {
+    if (rule.ratePerSecond == 0) {
+        return true;
+    }
+
+    unsigned long now = millis();
+    if (now - rule.windowStart >= 1000) {
+        rule.windowStart = now;
+        rule.windowCount = 0;
+    }
+    if (rule.windowCount >= rule.ratePerSecond) {
+        return false;
+    }
+    rule.windowCount++;
+    return true;
+}
+
+size_t LineFilter::processLine(uint8_t* out, uint64_t& firstCaptureUs) {
+    size_t written = 0;
+    firstCaptureUs = lineCaptureUs;
+    bool forward;
+    bool matched = false;
+
+    int index = findRule();
+    if (index >= 0) {
+        Rule& rule = rules[index];
+        forward = rule.forward && allowRate(rule);
+        matched = forward;
+
+        if (matched && rule.context > 0) {
+            written += flushHistory(out, rule.context, firstCaptureUs);
+            afterContext = max(afterContext, rule.context);
+        }
+    } else {
+        // 未命中规则的行：处于命中行的下文中则转发
+        forward = afterContext > 0 || !hasForwardRules;
+    }
+
+    if (!matched && afterContext > 0) {
+        afterContext--;
+    }
+
+    if (forward) {
+        memcpy(out + written, line, lineLength);
+        written += lineLength;
+        historyCount = 0; // 已转发的行之前的内容不再作为上文
+        forwardedLines++;
+    } else {
+        if (maxContext > 0) {
+            pushHistory();
+        }
+        droppedLines++;
+    }
+
+    lineLength = 0;
+    return written;
+}
+
+void LineFilter::pushHistory() {
+    memcpy(history[historyHead], line, lineLength);
+    historyLength[historyHead] = lineLength;
+    historyCaptureUs[historyHead] = lineCaptureUs;
+    historyHead = (historyHead + 1) % MAX_CONTEXT;
+    if (historyCount < MAX_CONTEXT) {
+        historyCount++;
+    }
+}
+
+size_t LineFilter::flushHistory(uint8_t* out, size_t lines, uint64_t& firstCaptureUs) {
+    size_t written = 0;
+    size_t count = min(lines, (size_t)historyCount);
+    if (count > 0) {
+        firstCaptureUs = historyCaptureUs[(historyHead + MAX_CONTEXT - count) % MAX_CONTEXT];
+    }
+
+    for (size_t i = count; i > 0; i--) {
+        size_t slot = (historyHead + MAX_CONTEXT - i) % MAX_CONTEXT;
+        memcpy(out + written, history[slot], historyLength[slot]);
+        written += historyLength[slot];
+    }
+
+    historyCount = 0;
+    return written;
+}
@@ -0,0 +1,111 @@
+#include "PowerManager.h"
+#include "FrameStamper.h"
+#if defined(ESP8266)
+  #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+  #include <WiFi.h>
+#endif
+
+const uint64_t PowerManager::STATS_WINDOW_US = 10000000; // 占空比统计窗口 10秒
+
+PowerManager::PowerManager()
+    : receiver(nullptr), enabled(false), wakePending(false), wakeTime(0), windowStart(0), windowSleep(0),
+      dutyCycle(100.0f), wakeups(0), spooledWakeups(0), avgWakeLatency(0), maxWakeLatency(0) {
+}
+
+void PowerManager::begin(SerialReceiver& serialReceiver) {
+    receiver = &serialReceiver;
+#if defined(ESP32)
+    WiFi.setSleep(true);  // WIFI_PS_MIN_MODEM
+#else
+    WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+#endif
+
+    enabled = true;
+    windowStart = FrameStamper::nowMicros();
+    windowSleep = 0;
+    Serial.println("Power save mode enabled");
+}
+
+bool PowerManager::isEnabled() const {
+    return enabled;
+}
+
+void PowerManager::waitForWork() {
+    if (!enabled || Serial.available()) {
+        return;
+    }
+
+#if defined(ESP32)
+    uint64_t start = FrameStamper::nowMicros();
+    receiver->waitForData(IDLE_WAIT_MS);
+    uint64_t now = FrameStamper::nowMicros();
+    // 只有阻塞在接收事件上的时间CPU真正停机，计为休眠
+    windowSleep += now - start;
+#else
+    // delay() 期间CPU仍在运行SDK任务，不计为休眠
+    for (uint32_t waited = 0; waited < IDLE_WAIT_MS && !Serial.available(); waited++) {
+        delay(1);
+    }
+    uint64_t now = FrameStamper::nowMicros();
+#endif
+
+    if (Serial.available()) {
+        wakeups++;
+        wakeTime = now;
+        wakePending = true;
+    }
+    updateWindow(now);
+}
+
+void PowerManager::noteForwarded() {
+    if (!wakePending) {
+        return;
+    }
+    wakePending = false;
+
+    uint32_t latency = FrameStamper::nowMicros() - wakeTime;
+    if (latency > maxWakeLatency) {
+        maxWakeLatency = latency;
+    }
+    // 指数移动平均 (1/8)
+    avgWakeLatency = avgWakeLatency == 0 ? latency : avgWakeLatency + ((int32_t)(latency - avgWakeLatency) >> 3);
+}
+
+void PowerManager::noteSpooled() {
+    if (!wakePending) {
+        return;
+    }
+    wakePending = false;
+    spooledWakeups++;
+}
+
+void PowerManager::updateWindow(uint64_t now) {
+    uint64_t elapsed = now - windowStart;
+    if (elapsed < STATS_WINDOW_US) {
+        return;
+    }
+    dutyCycle = 100.0f * (float)(elapsed - windowSleep) / (float)elapsed;
+    windowStart = now;
+    windowSleep = 0;
+}
+
+float PowerManager::getDutyCycle() const {
+    return dutyCycle;
+}
+
+uint32_t PowerManager::getWakeups() const {
+    return wakeups;
+}
+
+uint32_t PowerManager::getSpooledWakeups() const {
+    return spooledWakeups;
+}
+
+uint32_t PowerManager::getAvgWakeLatencyUs() const {
+    return avgWakeLatency;
+}
+
+uint32_t PowerManager::getMaxWakeLatencyUs() const {
+    return maxWakeLatency;
+}
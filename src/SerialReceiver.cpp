@@ -0,0 +1,64 @@
+#include "SerialReceiver.h"
+#include "FrameStamper.h"
+
+SerialReceiver::SerialReceiver() : stamped(false), firstRxUs(0) {
+#if defined(ESP32)
+    stampLock = nullptr;
+    rxSignal = nullptr;
+#endif
+}
+
+void SerialReceiver::begin() {
+#if defined(ESP32)
+    if (!stampLock) {
+        stampLock = xSemaphoreCreateMutex();
+        rxSignal = xSemaphoreCreateBinary();
+    }
+    Serial.onReceive([this]() {
+        onReceive();
+    });
+#endif
+}
+
+uint64_t SerialReceiver::getCaptureTime() const {
+    if (stamped.load(std::memory_order_acquire)) {
+        return firstRxUs;
+    }
+    return FrameStamper::nowMicros();
+}
+
+void SerialReceiver::markRead() {
+#if defined(ESP32)
+    // 与事件任务互斥：事件任务确认缓冲区有数据后才记录时间，
+    // 避免把已被读走的数据的时间留给下一批
+    xSemaphoreTake(stampLock, portMAX_DELAY);
+    if (!Serial.available()) {
+        stamped.store(false, std::memory_order_release);
+    }
+    xSemaphoreGive(stampLock);
+#endif
+}
+
+#if defined(ESP32)
+void SerialReceiver::onReceive() {
+    uint64_t now = FrameStamper::nowMicros();
+
+    xSemaphoreTake(stampLock, portMAX_DELAY);
+    if (!stamped.load(std::memory_order_relaxed) && Serial.available()) {
+        firstRxUs = now;
+        stamped.store(true, std::memory_order_release);
+    }
+    xSemaphoreGive(stampLock);
+
+    xSemaphoreGive(rxSignal);
+}
+
+bool SerialReceiver::waitForData(uint32_t timeoutMs) {
+    // 清除已被读取的数据留下的信号，再次确认无数据后阻塞
+    xSemaphoreTake(rxSignal, 0);
+    if (Serial.available()) {
+        return true;
+    }
+    return xSemaphoreTake(rxSignal, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+#endif
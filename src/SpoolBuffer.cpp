@@ -0,0 +1,109 @@
+#include "SpoolBuffer.h"
+#include "BufferUtil.h"
+
+SpoolBuffer::SpoolBuffer() : buffer(nullptr), capacity(0), readPos(0), used(0), droppedBytes(0) {
+}
+
+SpoolBuffer::~SpoolBuffer() {
+    free(buffer);
+}
+
+bool SpoolBuffer::begin(size_t size, bool usePsram) {
+    buffer = allocateBuffer("Spool", size, usePsram);
+    if (!buffer) {
+        return false;
+    }
+
+    capacity = size;
+    readPos = 0;
+    used = 0;
+    return true;
+}
+
+bool SpoolBuffer::isEnabled() const {
+    return buffer != nullptr;
+}
+
+bool SpoolBuffer::isEmpty() const {
+    return used == 0;
+}
+
+size_t SpoolBuffer::getUsed() const {
+    return used;
+}
+
+size_t SpoolBuffer::getCapacity() const {
+    return capacity;
+}
+
+uint32_t SpoolBuffer::getDroppedBytes() const {
+    return droppedBytes;
+}
+
+bool SpoolBuffer::push(const uint8_t* data, size_t len, uint32_t sequence, uint64_t captureUs) {
+    size_t recordSize = RECORD_HEADER_SIZE + len;
+    if (!buffer || len > 0xFFFF || recordSize > capacity) {
+        droppedBytes += len;
+        return false;
+    }
+
+    // 丢弃最旧的记录直到放得下
+    while (capacity - used < recordSize) {
+        droppedBytes += recordLength(readPos);
+        pop();
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    putLE(header, captureUs, 8);
+    putLE(header + 8, sequence, 4);
+    putLE(header + 12, len, 2);
+
+    size_t writePos = (readPos + used) % capacity;
+    copyIn(writePos, header, RECORD_HEADER_SIZE);
+    copyIn((writePos + RECORD_HEADER_SIZE) % capacity, data, len);
+    used += recordSize;
+    return true;
+}
+
+size_t SpoolBuffer::peek(uint8_t* out, size_t maxLen, uint32_t& sequence, uint64_t& captureUs) {
+    while (used > 0) {
+        uint8_t header[RECORD_HEADER_SIZE];
+        copyOut(readPos, header, RECORD_HEADER_SIZE);
+        size_t len = getLE(header + 12, 2);
+
+        if (len > maxLen) {
+            droppedBytes += len;
+            pop();
+            continue;
+        }
+
+        captureUs = getLE(header, 8);
+        sequence = getLE(header + 8, 4);
+        copyOut((readPos + RECORD_HEADER_SIZE) % capacity, out, len);
+        return len;
+    }
+    return 0;
+}
+
+void SpoolBuffer::pop() {
+    if (used == 0) {
+        return;
+    }
+    size_t recordSize = RECORD_HEADER_SIZE + recordLength(readPos);
+    readPos = (readPos + recordSize) % capacity;
+    used -= recordSize;
+}
+
+size_t SpoolBuffer::recordLength(size_t position) const {
+    uint8_t lengthField[2];
+    copyOut((position + 12) % capacity, lengthField, 2);
+    return lengthField[0] | (lengthField[1] << 8);
+}
+
+void SpoolBuffer::copyIn(size_t position, const uint8_t* data, size_t len) {
+    ringWrite(buffer, capacity, position, data, len);
+}
+
+void SpoolBuffer::copyOut(size_t position, uint8_t* out, size_t len) const {
+    ringRead(buffer, capacity, position, out, len);
+}
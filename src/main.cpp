@@ -8,14 +8,71 @@
 #endif
 #include <ESPAsyncWebServer.h>
 #include <WebSocketsClient.h>
+#include <memory>
 #include "Config.h"
 #include "ConfigPortal.h"
+#include "FrameStamper.h"
+#include "LineFilter.h"
+#include "CaptureRing.h"
+#include "PowerManager.h"
+#include "Profile.h"
+#include "FrameBuffer.h"
+#include "EndpointManager.h"
+#include "SpoolBuffer.h"
+#include "SerialReceiver.h"
+
+// 过滤器中未以换行结束的半行，串口空闲超过此时间后强制处理（毫秒）
+const unsigned long FILTER_FLUSH_TIMEOUT = 200;
+// 服务器端点健康检查（毫秒）
+const unsigned long ENDPOINT_CONNECT_TIMEOUT = 10000; // 超过此时间未连上记一次失败
+const unsigned long ENDPOINT_PING_INTERVAL = 10000;   // 已连接时测量RTT的间隔
+const unsigned long ENDPOINT_PONG_TIMEOUT = 5000;     // ping无响应记一次失败
+const unsigned long ENDPOINT_PROBE_INTERVAL = 60000;  // 探测其他端点的间隔
+// 每次循环最多补发的待发记录数，避免补发期间长时间不处理串口
+const int SPOOL_DRAIN_RECORDS = 4;
 
 // --- Globals ---
 ConfigManager configManager;
 ConfigPortal* configPortal = nullptr;
-AsyncWebServer* server = nullptr; // Used for Config Portal only
+AsyncWebServer* server = nullptr; // Normal mode HTTP server (capture download, stats)
 WebSocketsClient webSocket;
+FrameStamper frameStamper;
+LineFilter lineFilter;
+// 串口读取缓冲区和过滤输出缓冲区，尺寸由平台配置决定，放在静态区而非栈上
+FrameBuffer<BRIDGE_SERIAL_CHUNK_SIZE> rxFrame;
+FrameBuffer<BRIDGE_SERIAL_CHUNK_SIZE + LineFilter::MAX_EXPANSION> filterFrame;
+unsigned long lastSerialRxTime = 0;
+CaptureRing captureRing;
+PowerManager powerManager;
+SerialReceiver serialReceiver;
+EndpointManager endpointManager;
+SpoolBuffer spoolBuffer;
+String deviceId;
+bool endpointSwitching = false;
+unsigned long endpointConnectStart = 0;
+unsigned long lastPingTime = 0;
+bool pingPending = false;
+unsigned long lastProbeTime = 0;
+
+// 内部RAM预算：静态缓冲区 + UART驱动缓冲区 + 内部RAM中的抓包缓冲区和待发缓冲区
+static_assert(sizeof(rxFrame) + sizeof(filterFrame) + sizeof(LineFilter) + sizeof(CaptureRing)
+              + sizeof(SpoolBuffer) + BRIDGE_UART_RX_BUFFER + BRIDGE_UART_TX_BUFFER
+              + BRIDGE_HEAP_BUFFERS_INTERNAL <= BRIDGE_RAM_BUDGET,
+              "Buffers exceed BRIDGE_RAM_BUDGET for this profile");
+
+// 编译输出中的尺寸报告
+#define BRIDGE_STR_(x) #x
+#define BRIDGE_STR(x) BRIDGE_STR_(x)
+#pragma message("Bridge profile " BRIDGE_PROFILE_NAME \
+                ": serial chunk=" BRIDGE_STR(BRIDGE_SERIAL_CHUNK_SIZE) \
+                ", uart rx=" BRIDGE_STR(BRIDGE_UART_RX_BUFFER) \
+                ", uart tx=" BRIDGE_STR(BRIDGE_UART_TX_BUFFER) \
+                ", filter line=" BRIDGE_STR(BRIDGE_FILTER_MAX_LINE) \
+                ", capture=" BRIDGE_STR(BRIDGE_CAPTURE_CAPACITY) \
+                ", spool=" BRIDGE_STR(BRIDGE_SPOOL_CAPACITY) \
+                ", psram=" BRIDGE_STR(BRIDGE_USE_PSRAM) \
+                ", ram budget=" BRIDGE_STR(BRIDGE_RAM_BUDGET) \
+                ", psram budget=" BRIDGE_STR(BRIDGE_PSRAM_BUDGET))
 
 DeviceConfig currentConfig;
 bool inConfigMode = false;
@@ -26,84 +83,287 @@ void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
   switch(type) {
     case WStype_DISCONNECTED:
       Serial.println("[WSc] Disconnected!");
+      if (!endpointSwitching) {
+        endpointManager.recordFailure(endpointManager.getCurrent());
+      }
+      endpointConnectStart = millis();
+      pingPending = false;
       break;
     case WStype_CONNECTED:
       Serial.printf("[WSc] Connected to url: %s\n", payload);
+      endpointManager.recordSuccess(endpointManager.getCurrent());
+      lastPingTime = millis();
       break;
     case WStype_TEXT:
       // Serial.printf("[WSc] get text: %s\n", payload);
+      captureRing.append(CaptureRing::DIR_NET_TO_SERIAL, payload, length, FrameStamper::nowMicros());
       Serial.write(payload, length);
       break;
     case WStype_BIN:
       // Serial.printf("[WSc] get binary length: %u\n", length);
+      captureRing.append(CaptureRing::DIR_NET_TO_SERIAL, payload, length, FrameStamper::nowMicros());
       Serial.write(payload, length);
       break;
-    case WStype_PING:
     case WStype_PONG:
+      if (pingPending) {
+        pingPending = false;
+        endpointManager.recordLatency(endpointManager.getCurrent(), millis() - lastPingTime);
+        endpointManager.recordSuccess(endpointManager.getCurrent());
+      }
+      break;
+    case WStype_PING:
     case WStype_ERROR:
       break;
   }
 }
 
-void startConfigMode() {
-  Serial.println("\n=== Entering Configuration Mode ===");
-  inConfigMode = true;
-  configModeStartTime = millis();
+// WiFi断开时不调用 webSocket.loop()，连接状态可能尚未更新，因此同时检查WiFi
+bool isBridgeConnected() {
+  return WiFi.status() == WL_CONNECTED && webSocket.isConnected();
+}
+
+// 通过WebSocket发送一帧，frame 前 HEADER_SIZE 字节为帧头预留空间
+bool transmitFrame(uint8_t* frame, size_t count, uint32_t sequence, uint64_t captureUs) {
+  if (currentConfig.timestamp_frames) {
+    frameStamper.writeHeader(frame, sequence, captureUs);
+    return webSocket.sendBIN(frame, FrameStamper::HEADER_SIZE + count);
+  }
+  // Send as TEXT, assuming ASCII protocol like the simulator.
+  // Note: sendTXT expects null-terminated char* or String, or (uint8_t*, len).
+  return webSocket.sendTXT(frame + FrameStamper::HEADER_SIZE, count);
+}
+
+// 发送一块串口数据；未连接、发送失败或仍有未补发的数据时存入待发缓冲区，保证顺序
+void sendSerialFrame(uint8_t* frame, size_t count, uint64_t captureUs) {
+  // 数据全部被过滤时也结束本次唤醒的延迟统计
+  if (count == 0) {
+    powerManager.noteForwarded();
+    return;
+  }
+
+  // 序号在组帧时分配，发送失败进入待发缓冲区后补发时沿用
+  uint32_t sequence = frameStamper.nextSequence();
+  if (spoolBuffer.isEmpty() && isBridgeConnected() && transmitFrame(frame, count, sequence, captureUs)) {
+    // 延迟统计包含发送耗时
+    powerManager.noteForwarded();
+  } else {
+    spoolBuffer.push(frame + FrameStamper::HEADER_SIZE, count, sequence, captureUs);
+    powerManager.noteSpooled();
+  }
+}
+
+// 按顺序补发待发缓冲区中的数据（已连接时调用）
+void drainSpool() {
+  for (int i = 0; i < SPOOL_DRAIN_RECORDS && !spoolBuffer.isEmpty(); i++) {
+    uint32_t sequence = 0;
+    uint64_t captureUs = 0;
+    size_t count = spoolBuffer.peek(filterFrame.payload(), filterFrame.CAPACITY, sequence, captureUs);
+    if (count == 0 || !transmitFrame(filterFrame.data, count, sequence, captureUs)) {
+      break;
+    }
+    spoolBuffer.pop();
+  }
+}
+
+// Serial -> WebSocket
+// 串口始终读取，断线或切换端点期间的数据进入待发缓冲区，连接后补发
+void bridgeSerial() {
+  if (isBridgeConnected()) {
+    drainSpool();
+  }
   
-  configPortal = new ConfigPortal(&configManager);
-  configPortal->start();
+  if (Serial.available()) {
+    uint8_t* buffer = rxFrame.payload();
+    size_t count = 0;
+    uint64_t captureUs = serialReceiver.getCaptureTime();
+    
+    while (Serial.available() && count < rxFrame.CAPACITY) {
+      buffer[count++] = Serial.read();
+      if (!Serial.available()) {
+        delay(1);
+      }
+    }
+    serialReceiver.markRead();
+    lastSerialRxTime = millis();
+    captureRing.append(CaptureRing::DIR_SERIAL_TO_NET, buffer, count, captureUs);
+
+    if (lineFilter.isActive()) {
+      // 只转发过滤后的完整行
+      uint64_t lineCaptureUs = captureUs;
+      count = lineFilter.feed(buffer, count, captureUs, filterFrame.payload(), lineCaptureUs);
+      sendSerialFrame(filterFrame.data, count, lineCaptureUs);
+    } else {
+      sendSerialFrame(rxFrame.data, count, captureUs);
+    }
+  } else if (lineFilter.hasPending() && millis() - lastSerialRxTime > FILTER_FLUSH_TIMEOUT) {
+    // 串口空闲，处理没有换行结尾的半行（例如命令提示符）
+    uint64_t captureUs = 0;
+    size_t count = lineFilter.flush(filterFrame.payload(), captureUs);
+    sendSerialFrame(filterFrame.data, count, captureUs);
+  }
+}
+
+// 启动正常模式下的HTTP服务器，提供抓包下载和运行状态
+void startHttpServer() {
+  server = new AsyncWebServer(80);
+  
+  // GET /capture - 以流的形式下载抓包缓冲区（格式见 CaptureRing.h）
+  server->on("/capture", HTTP_GET, [](AsyncWebServerRequest* request) {
+    std::shared_ptr<CaptureRing::Reader> reader = std::make_shared<CaptureRing::Reader>(
+      captureRing.openReader(FrameStamper::nowMicros(), frameStamper.getClockOffset(), frameStamper.isSynced()));
+    
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+      [reader](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        size_t written = captureRing.read(*reader, buffer, maxLen);
+        if (written == 0 && !captureRing.isDone(*reader)) {
+          return RESPONSE_TRY_AGAIN; // 本次空间不足一条记录
+        }
+        return written;
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"capture.scap\"");
+    request->send(response);
+  });
+  
+  // GET /stats - 运行状态（JSON）
+  server->on("/stats", HTTP_GET, [](AsyncWebServerRequest* request) {
+    String json = "{";
+    json += "\"uptime_s\":" + String(millis() / 1000);
+    json += ",\"free_heap\":" + String(ESP.getFreeHeap());
+    json += ",\"power_save\":" + String(powerManager.isEnabled() ? "true" : "false");
+    json += ",\"duty_cycle\":" + String(powerManager.getDutyCycle(), 1);
+    json += ",\"wakeups\":" + String(powerManager.getWakeups());
+    json += ",\"wakeups_spooled\":" + String(powerManager.getSpooledWakeups());
+    json += ",\"wake_latency_avg_us\":" + String(powerManager.getAvgWakeLatencyUs());
+    json += ",\"wake_latency_max_us\":" + String(powerManager.getMaxWakeLatencyUs());
+    json += ",\"filter_forwarded_lines\":" + String(lineFilter.getForwardedLines());
+    json += ",\"filter_dropped_lines\":" + String(lineFilter.getDroppedLines());
+    json += ",\"spool_bytes\":" + String(spoolBuffer.getUsed());
+    json += ",\"spool_dropped_bytes\":" + String(spoolBuffer.getDroppedBytes());
+    json += ",\"endpoint_current\":" + String(endpointManager.getCurrent());
+    json += ",\"endpoints\":[";
+    for (size_t i = 0; i < endpointManager.getCount(); i++) {
+      if (i > 0) {
+        json += ",";
+      }
+      json += "{\"url\":\"" + String(endpointManager.getUrl(i)) + "\"";
+      json += ",\"healthy\":" + String(endpointManager.isHealthy(i) ? "true" : "false");
+      json += ",\"latency_ms\":" + String(endpointManager.getLatency(i));
+      json += ",\"failures\":" + String(endpointManager.getFailures(i)) + "}";
+    }
+    json += "]";
+    json += "}";
+    request->send(200, "application/json", json);
+  });
+  
+  server->begin();
+  Serial.printf("Capture download: http://%s/capture\n", WiFi.localIP().toString().c_str());
 }
 
-void parseUrl(const char* url, String& host, int& port, String& path) {
-  String urlStr = String(url);
+// 连接到指定的服务器端点（切换时先断开当前连接）
+void connectEndpoint(int index) {
+  if (endpointManager.getCurrent() >= 0) {
+    endpointSwitching = true;
+    webSocket.disconnect();
+    endpointSwitching = false;
+  }
+  endpointManager.setCurrent(index);
+  
+  String host;
+  int port = 80;
+  String path;
+  EndpointManager::parseUrl(endpointManager.getUrl(index), host, port, path);
   
-  // Remove ws:// or wss://
-  if (urlStr.startsWith("ws://")) {
-    urlStr = urlStr.substring(5);
-    port = 80;
-  } else if (urlStr.startsWith("wss://")) {
-    urlStr = urlStr.substring(6);
-    port = 443;
+  // Append ID to path
+  if (path.indexOf('?') == -1) {
+    path += "?id=" + deviceId;
+  } else {
+    path += "&id=" + deviceId;
   }
   
-  int firstSlash = urlStr.indexOf('/');
-  int firstColon = urlStr.indexOf(':');
+  BRIDGE_LOG("Connecting to WebSocket Server [%d]: %s:%d%s\n", index, host.c_str(), port, path.c_str());
   
-  if (firstColon != -1 && (firstSlash == -1 || firstColon < firstSlash)) {
-    // Has port
-    host = urlStr.substring(0, firstColon);
-    if (firstSlash != -1) {
-      port = urlStr.substring(firstColon + 1, firstSlash).toInt();
-      path = urlStr.substring(firstSlash);
-    } else {
-      port = urlStr.substring(firstColon + 1).toInt();
-      path = "/";
+  webSocket.begin(host, port, path);
+  endpointConnectStart = millis();
+  pingPending = false;
+}
+
+// 端点健康检查、RTT测量、探测以及故障切换/回切
+void maintainEndpoint() {
+  if (endpointManager.getCount() == 0) {
+    return;
+  }
+  
+  int current = endpointManager.getCurrent();
+  unsigned long now = millis();
+  endpointManager.updateProbe();
+  
+  if (!webSocket.isConnected()) {
+    if (now - endpointConnectStart > ENDPOINT_CONNECT_TIMEOUT) {
+      BRIDGE_LOG("[WSc] Endpoint %d connect timeout\n", current);
+      endpointManager.recordFailure(current);
+      endpointConnectStart = now;
     }
   } else {
-    // No port
-    if (firstSlash != -1) {
-      host = urlStr.substring(0, firstSlash);
-      path = urlStr.substring(firstSlash);
-    } else {
-      host = urlStr;
-      path = "/";
+    if (pingPending && now - lastPingTime > ENDPOINT_PONG_TIMEOUT) {
+      BRIDGE_LOG("[WSc] Endpoint %d ping timeout\n", current);
+      endpointManager.recordFailure(current);
+      pingPending = false;
+    }
+    if (!pingPending && now - lastPingTime > ENDPOINT_PING_INTERVAL) {
+      webSocket.sendPing();
+      lastPingTime = now;
+      pingPending = true;
     }
+    
+    // 探测是异步的；仍有待补发数据时先不探测，避免与补发争用带宽
+    if (endpointManager.getCount() > 1
+        && now - lastProbeTime > ENDPOINT_PROBE_INTERVAL
+        && spoolBuffer.isEmpty()) {
+      endpointManager.startProbe();
+      lastProbeTime = now;
+    }
+  }
+  
+  int target = endpointManager.selectSwitchTarget();
+  if (target >= 0) {
+    BRIDGE_LOG("[WSc] Switching endpoint %d -> %d\n", current, target);
+    connectEndpoint(target);
   }
 }
 
+void startConfigMode() {
+  Serial.println("\n=== Entering Configuration Mode ===");
+  inConfigMode = true;
+  configModeStartTime = millis();
+  
+  configPortal = new ConfigPortal(&configManager);
+  configPortal->start();
+}
+
 void startNormalMode() {
   Serial.println("\n=== Starting Normal Mode ===");
   
   // 加载配置
   currentConfig = configManager.getConfig();
+  lineFilter.compile(currentConfig.filter_rules);
+  
+  captureRing.begin(BRIDGE_CAPTURE_CAPACITY, BRIDGE_USE_PSRAM);
+  spoolBuffer.begin(BRIDGE_SPOOL_CAPACITY, BRIDGE_USE_PSRAM);
   
   // 初始化串口（使用配置的波特率）
   Serial.end();
+  Serial.setRxBufferSize(BRIDGE_UART_RX_BUFFER);
+#if defined(ESP32)
+  Serial.setTxBufferSize(BRIDGE_UART_TX_BUFFER);
+#endif
   Serial.begin(currentConfig.serial_baud_rate);
+  serialReceiver.begin();
   delay(100);
   
   Serial.println("--- ESP32 WebSocket Serial Bridge (Client Mode) ---");
   Serial.printf("Serial Baud Rate: %d\n", currentConfig.serial_baud_rate);
+  Serial.printf("Profile: %s (chunk %u, uart rx %u)\n", BRIDGE_PROFILE_NAME,
+                (unsigned)BRIDGE_SERIAL_CHUNK_SIZE, (unsigned)BRIDGE_UART_RX_BUFFER);
   
   // 连接WiFi
   WiFi.mode(WIFI_STA);
@@ -122,32 +382,28 @@ void startNormalMode() {
     Serial.print("Connected! IP Address: ");
     Serial.println(WiFi.localIP());
     
-    // 连接WebSocket服务器
-    String host;
-    int port = 80;
-    String path;
+    if (currentConfig.timestamp_frames) {
+      frameStamper.begin(currentConfig.ntp_server);
+    }
     
-    if (strlen(currentConfig.websocket_url) > 0) {
-      parseUrl(currentConfig.websocket_url, host, port, path);
-      
+    startHttpServer();
+    
+    if (currentConfig.power_save) {
+      powerManager.begin(serialReceiver);
+    }
+    
+    // 连接WebSocket服务器
+    if (endpointManager.begin(currentConfig) > 0) {
       // Generate Device ID from MAC Address
       String mac = WiFi.macAddress();
       mac.replace(":", "");
-      String deviceId = "esp32-" + mac;
-      
-      // Append ID to path
-      if (path.indexOf('?') == -1) {
-        path += "?id=" + deviceId;
-      } else {
-        path += "&id=" + deviceId;
-      }
-      
-      Serial.printf("Connecting to WebSocket Server: %s:%d%s\n", host.c_str(), port, path.c_str());
+      deviceId = "esp32-" + mac;
       Serial.printf("Device ID: %s\n", deviceId.c_str());
+      Serial.printf("WebSocket endpoints: %u\n", (unsigned)endpointManager.getCount());
       
-      webSocket.begin(host, port, path);
       webSocket.onEvent(webSocketEvent);
       webSocket.setReconnectInterval(5000);
+      connectEndpoint(endpointManager.selectBest());
     } else {
       Serial.println("No WebSocket URL configured!");
     }
@@ -196,6 +452,11 @@ void loop() {
     // 正常模式循环
     if (WiFi.status() == WL_CONNECTED) {
       webSocket.loop();
+      maintainEndpoint();
+      
+      if (currentConfig.timestamp_frames) {
+        frameStamper.update();
+      }
       
       if (currentConfig.simulate_serial) {
         static unsigned long lastSimTime = 0;
@@ -211,41 +472,6 @@ void loop() {
           webSocket.sendTXT(simData);
           Serial.print("Generated:\n" + simData);
         }
-      } else {
-        // Serial -> WebSocket
-        if (Serial.available()) {
-          uint8_t buffer[256];
-          size_t count = 0;
-          
-          while (Serial.available() && count < sizeof(buffer)) {
-            buffer[count++] = Serial.read();
-            if (!Serial.available()) {
-              delay(1);
-            }
-          }
-
-          if (count > 0) {
-            // Send as Text or Binary? 
-            // Simulator sends Stdin as Text. Let's try Text first, or Binary if it contains nulls?
-            // For transparency, Binary is safer, but Simulator uses Text for Stdin.
-            // Let's use sendTXT for now as requested to match simulator behavior for "text" input.
-            // But for generic serial bridge, Binary is better.
-            // Given the user referenced the simulator which sends text, I'll send TEXT.
-            // However, Serial data might be binary.
-            // Let's check if it's printable.
-            
-            bool isText = true;
-            for(size_t i=0; i<count; i++) {
-                if (buffer[i] < 9 && buffer[i] != 0) { // Allow 0? No, C-string.
-                   // Simple check
-                }
-            }
-            // Just send as TEXT for now, assuming ASCII protocol like the simulator.
-            // webSocket.sendTXT(buffer, count); 
-            // Note: sendTXT expects null-terminated char* or String, or (uint8_t*, len).
-            webSocket.sendTXT(buffer, count);
-          }
-        }
       }
     } else {
       static unsigned long lastReconnectAttempt = 0;
@@ -255,5 +481,14 @@ void loop() {
         lastReconnectAttempt = millis();
       }
     }
+    
+    if (!currentConfig.simulate_serial) {
+      bridgeSerial();
+    }
+    
+    // 低功耗模式：无串口数据时休眠等待，代替空转；补发积压数据期间不休眠
+    if (spoolBuffer.isEmpty() || !isBridgeConnected()) {
+      powerManager.waitForWork();
+    }
   }
 }
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""将设备 /capture 下载的抓包文件 (.scap) 转换为 pcap 格式。
+
+用法:
+    curl -o capture.scap http://<设备IP>/capture
+    python3 tools/capture2pcap.py capture.scap capture.pcap
+
+输出使用 LINKTYPE_USER0 (147)，每个数据包的第1个字节为方向:
+    0 = 串口 -> 网络, 1 = 网络 -> 串口
+在 Wireshark 中可通过 "DLT User" 协议配置解析其后的负载。
+"""
+
+import struct
+import sys
+
+FILE_HEADER = struct.Struct("<4sBBHQq")
+RECORD_HEADER = struct.Struct("<IHH")
+LINKTYPE_USER0 = 147
+
+
+def convert(src, dst):
+    data = open(src, "rb").read()
+    if len(data) < FILE_HEADER.size:
+        raise ValueError("file too short")
+
+    magic, version, flags, _, now_us, offset_us = FILE_HEADER.unpack_from(data, 0)
+    if magic != b"SCAP" or version != 1:
+        raise ValueError("not a capture file")
+
+    synced = bool(flags & 0x01)
+    if not synced:
+        print("warning: device clock not synced, timestamps are relative to boot", file=sys.stderr)
+        offset_us = 0
+
+    now_ms = now_us // 1000
+    count = 0
+
+    with open(dst, "wb") as out:
+        out.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, LINKTYPE_USER0))
+
+        pos = FILE_HEADER.size
+        while pos + RECORD_HEADER.size <= len(data):
+            ts_ms, ts_us, length_dir = RECORD_HEADER.unpack_from(data, pos)
+            length = length_dir & 0x7FFF
+            direction = length_dir >> 15
+            payload = data[pos + RECORD_HEADER.size:pos + RECORD_HEADER.size + length]
+            if len(payload) < length:
+                break  # 下载被截断
+            pos += RECORD_HEADER.size + length
+
+            # ts_ms 只有低32位，以下载时刻为参考还原完整时间
+            full_ms = now_ms - ((now_ms - ts_ms) & 0xFFFFFFFF)
+            ts = full_ms * 1000 + ts_us + offset_us
+
+            packet = bytes([direction]) + payload
+            out.write(struct.pack("<IIII", ts // 1000000, ts % 1000000, len(packet), len(packet)))
+            out.write(packet)
+            count += 1
+
+    print("%d records written to %s" % (count, dst))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    convert(sys.argv[1], sys.argv[2])